@@ -0,0 +1,432 @@
+/**
+ * @file chunkedInput.c
+ *
+ * Memory mapped log files, decoded in parallel chunks
+ */
+
+#define _GNU_SOURCE  /* fopencookie(), mremap() */
+
+/**
+Section: Included Files
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "chunkedInput.h"
+#include "lineReader.h"
+
+/**
+Section: Definitions
+*/
+
+#define CHUNKED_INPUT_OUTPUT_BLOCK 65536  /**< Initial output buffer of a chunk, a multiple of the page size */
+
+/**
+Section: Private Types
+*/
+
+/**
+ * Output buffers are mapped directly rather than allocated, so they are
+ * returned to the system when written instead of staying in the malloc
+ * arenas of the workers, and grow without copying.
+ */
+typedef struct
+{
+	char *buffer;
+	size_t length;
+	size_t capacity;  /**< Size of the buffer mapping, 0 without buffer */
+	int done;
+	int failed;  /**< The handler failed, nothing behind this chunk is written */
+} ChunkOutput_t;
+
+typedef struct
+{
+	const char *data;
+	size_t size;
+	size_t chunkCount;
+	size_t nextChunk;      /**< Next chunk handed to a worker */
+	size_t nextOutput;     /**< Next chunk written to the output */
+	ChunkOutput_t *slots;  /**< Outputs of the chunks in flight, indexed by chunk % window */
+	size_t window;
+	size_t buffered;       /**< Output buffer capacity of the chunks in flight, up to CHUNKED_INPUT_OUTPUT_LIMIT */
+	int failed;
+	int stopped;           /**< A handler failed, no more chunks are decoded */
+
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+
+	ChunkHandler_t handler;
+	void *context;
+	FILE *output;
+} ChunkedInput_t;
+
+/** Output stream of a chunk being decoded */
+typedef struct
+{
+	ChunkedInput_t *input;
+	size_t chunk;
+	ChunkOutput_t *out;
+} ChunkStream_t;
+
+/**
+Section: Private functions
+*/
+
+/**
+ * @brief      Returns the start of a chunk: the first line starting at or behind its nominal offset
+ *
+ * @param[in]  input  The input
+ * @param[in]  chunk  The chunk index, may be chunkCount for the end of the file
+ *
+ * @return     The offset of the chunk
+ */
+static size_t ChunkedInput_ChunkStart(const ChunkedInput_t *input, size_t chunk)
+{
+	size_t offset = chunk * CHUNKED_INPUT_CHUNK_SIZE;
+	const char *newline;
+
+	if (0 == chunk)
+	{
+		return 0;
+	}
+	if (offset >= input->size)
+	{
+		return input->size;
+	}
+
+	newline = memchr(input->data + offset - 1, '\n', input->size - offset + 1);
+	return (NULL == newline) ? input->size : (size_t) (newline - input->data) + 1;
+}
+
+/* Unmaps the output buffer of a chunk */
+static void ChunkedInput_FreeOutput(ChunkOutput_t *out)
+{
+	if (out->capacity > 0)
+	{
+		munmap(out->buffer, out->capacity);
+	}
+}
+
+/**
+ * @brief      Write function of a chunk stream, appends to the output buffer of the chunk
+ *
+ * Growing the buffer beyond the output limit waits for room. The chunk that
+ * is written next doesn't wait: everything before it has been written, so
+ * it writes its buffer and the data to the output itself.
+ *
+ * @param      cookie  The ChunkStream_t
+ * @param[in]  data    The data
+ * @param[in]  size    Size of the data
+ *
+ * @return     size, or -1 if the buffer can't grow
+ */
+static ssize_t ChunkedInput_Write(void *cookie, const char *data, size_t size)
+{
+	ChunkStream_t *stream = cookie;
+	ChunkedInput_t *input = stream->input;
+	ChunkOutput_t *out = stream->out;
+	size_t capacity, growth;
+	char *buffer;
+	int direct;
+
+	if (out->length + size > out->capacity)
+	{
+		capacity = out->capacity ? out->capacity : CHUNKED_INPUT_OUTPUT_BLOCK;
+		while (capacity < out->length + size)
+		{
+			capacity *= 2;
+		}
+		growth = capacity - out->capacity;
+
+		pthread_mutex_lock(&input->lock);
+		while (!input->stopped && input->nextOutput < stream->chunk && input->buffered + growth > CHUNKED_INPUT_OUTPUT_LIMIT)
+		{
+			pthread_cond_wait(&input->cond, &input->lock);
+		}
+		if (input->stopped)
+		{
+			/* A chunk before this one failed, its output is never written */
+			pthread_mutex_unlock(&input->lock);
+			out->length = 0;
+			return size;
+		}
+		direct = (input->buffered + growth > CHUNKED_INPUT_OUTPUT_LIMIT);
+		if (!direct)
+		{
+			input->buffered += growth;
+		}
+		pthread_mutex_unlock(&input->lock);
+
+		if (direct)
+		{
+			fwrite(out->buffer, 1, out->length, input->output);
+			fwrite(data, 1, size, input->output);
+			out->length = 0;
+			return size;
+		}
+
+		buffer = out->capacity ? mremap(out->buffer, out->capacity, capacity, MREMAP_MAYMOVE) :
+			mmap(NULL, capacity, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (MAP_FAILED == buffer)
+		{
+			pthread_mutex_lock(&input->lock);
+			input->buffered -= growth;
+			input->failed = 1;
+			pthread_cond_broadcast(&input->cond);
+			pthread_mutex_unlock(&input->lock);
+			return -1;
+		}
+		out->buffer = buffer;
+		out->capacity = capacity;
+	}
+
+	memcpy(out->buffer + out->length, data, size);
+	out->length += size;
+
+	return size;
+}
+
+/**
+ * @brief      Decodes one chunk into a memory stream
+ *
+ * @param      input  The input
+ * @param[in]  chunk  The chunk index
+ * @param[out] out    The decoded chunk
+ */
+static void ChunkedInput_Decode(ChunkedInput_t *input, size_t chunk, ChunkOutput_t *out)
+{
+	cookie_io_functions_t functions = { NULL, ChunkedInput_Write, NULL, NULL };
+	size_t start = ChunkedInput_ChunkStart(input, chunk);
+	size_t end = ChunkedInput_ChunkStart(input, chunk + 1);
+	ChunkStream_t cookie = { input, chunk, out };
+	FILE *stream;
+
+	out->buffer = NULL;
+	out->length = 0;
+	out->capacity = 0;
+	out->failed = 0;
+
+	stream = fopencookie(&cookie, "w", functions);
+	if (NULL == stream)
+	{
+		pthread_mutex_lock(&input->lock);
+		input->failed = 1;
+		pthread_mutex_unlock(&input->lock);
+		return;
+	}
+	if (end > start && input->handler(input->data + start, end - start, stream, input->context))
+	{
+		out->failed = 1;
+	}
+	fclose(stream);
+}
+
+static void *ChunkedInput_Worker(void *arg)
+{
+	ChunkedInput_t *input = arg;
+	ChunkOutput_t out;
+	size_t chunk;
+
+	pthread_mutex_lock(&input->lock);
+	for (;;)
+	{
+		/* Don't run too far ahead of the writer */
+		while (!input->stopped && input->nextChunk < input->chunkCount && input->nextChunk >= input->nextOutput + input->window)
+		{
+			pthread_cond_wait(&input->cond, &input->lock);
+		}
+		if (input->stopped || input->nextChunk >= input->chunkCount)
+		{
+			break;
+		}
+		chunk = input->nextChunk++;
+		pthread_mutex_unlock(&input->lock);
+
+		ChunkedInput_Decode(input, chunk, &out);
+
+		pthread_mutex_lock(&input->lock);
+		out.done = 1;
+		input->slots[chunk % input->window] = out;
+		pthread_cond_broadcast(&input->cond);
+	}
+	pthread_mutex_unlock(&input->lock);
+
+	return NULL;
+}
+
+/**
+ * @brief      Decodes a file that can't be mapped line by line on the calling thread
+ *
+ * @param[in]  fd       The file descriptor, closed when done
+ * @param[in]  handler  The chunk handler, called with single lines
+ * @param      context  Passed to handler
+ * @param      output   Where the decoded lines are written to
+ *
+ * @return     0 on success, CHUNK_HANDLER_FAILED if the handler failed and a negative value otherwise
+ */
+static int ChunkedInput_ProcessStream(int fd, ChunkHandler_t handler, void *context, FILE *output)
+{
+	LineReader_t reader;
+	char *line;
+	size_t length;
+	int ret;
+
+	if (LineReader_Init(&reader, fd, LINE_READER_BLOCK_SIZE))
+	{
+		close(fd);
+		return -1;
+	}
+	while ((ret = LineReader_Next(&reader, &line, &length)) > 0)
+	{
+		if (handler(line, length, output, context))
+		{
+			ret = CHUNK_HANDLER_FAILED;
+			break;
+		}
+	}
+	LineReader_DeInit(&reader);
+	close(fd);
+
+	return ret;
+}
+
+/**
+Section: Implementation
+*/
+
+int ChunkedInput_ProcessFile(const char *path, unsigned int workers, ChunkHandler_t handler, void *context, FILE *output)
+{
+	ChunkedInput_t input;
+	ChunkOutput_t out;
+	pthread_t *threads;
+	struct stat st;
+	unsigned int i, started = 0;
+	void *map;
+	int fd, ret;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return -1;
+	}
+	if (fstat(fd, &st) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	/* Pipes, FIFOs and devices report a size of 0 but have data */
+	if (!S_ISREG(st.st_mode))
+	{
+		return ChunkedInput_ProcessStream(fd, handler, context, output);
+	}
+	if (0 == st.st_size)
+	{
+		close(fd);
+		return 0;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == map)
+	{
+		return -1;
+	}
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	memset(&input, 0, sizeof(input));
+	input.data = map;
+	input.size = st.st_size;
+	input.chunkCount = (input.size + CHUNKED_INPUT_CHUNK_SIZE - 1) / CHUNKED_INPUT_CHUNK_SIZE;
+	input.handler = handler;
+	input.context = context;
+	input.output = output;
+
+	if (workers <= 1)
+	{
+		/* Decode on the calling thread, straight into the output */
+		ret = handler(input.data, input.size, output, context);
+		munmap(map, st.st_size);
+		return ret ? CHUNK_HANDLER_FAILED : 0;
+	}
+
+	input.window = (size_t) workers * CHUNKED_INPUT_WINDOW;
+	input.slots = calloc(input.window, sizeof(ChunkOutput_t));
+	threads = malloc(workers * sizeof(pthread_t));
+	pthread_mutex_init(&input.lock, NULL);
+	pthread_cond_init(&input.cond, NULL);
+
+	for (i = 0; i < workers; i++)
+	{
+		if (0 == pthread_create(&threads[i], NULL, ChunkedInput_Worker, &input))
+		{
+			started++;
+		}
+	}
+	if (0 == started)
+	{
+		/* No threads available, decode on the calling thread */
+		pthread_cond_destroy(&input.cond);
+		pthread_mutex_destroy(&input.lock);
+		free(threads);
+		free(input.slots);
+		ret = handler(input.data, input.size, output, context);
+		munmap(map, st.st_size);
+		return ret ? CHUNK_HANDLER_FAILED : 0;
+	}
+
+	/*
+	 * Write the chunks in file order. A chunk only counts as written once its
+	 * output is, the next chunk may write to the output directly from then on.
+	 */
+	pthread_mutex_lock(&input.lock);
+	while (!input.stopped && input.nextOutput < input.chunkCount)
+	{
+		while (!input.slots[input.nextOutput % input.window].done)
+		{
+			pthread_cond_wait(&input.cond, &input.lock);
+		}
+		out = input.slots[input.nextOutput % input.window];
+		input.slots[input.nextOutput % input.window].done = 0;
+		pthread_mutex_unlock(&input.lock);
+
+		fwrite(out.buffer, 1, out.length, output);
+		ChunkedInput_FreeOutput(&out);
+
+		pthread_mutex_lock(&input.lock);
+		input.buffered -= out.capacity;
+		input.nextOutput++;
+		input.stopped = out.failed;
+		pthread_cond_broadcast(&input.cond);
+	}
+	pthread_mutex_unlock(&input.lock);
+
+	for (i = 0; i < started; i++)
+	{
+		pthread_join(threads[i], NULL);
+	}
+	/* Chunks decoded behind a failed one */
+	for (i = 0; i < input.window; i++)
+	{
+		if (input.slots[i].done)
+		{
+			ChunkedInput_FreeOutput(&input.slots[i]);
+		}
+	}
+
+	pthread_cond_destroy(&input.cond);
+	pthread_mutex_destroy(&input.lock);
+	free(threads);
+	free(input.slots);
+	munmap(map, st.st_size);
+
+	if (input.stopped)
+	{
+		return CHUNK_HANDLER_FAILED;
+	}
+	return input.failed ? -1 : 0;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file chunkedInput.h
+ *
+ * Memory mapped log files, decoded in parallel chunks
+ */
+
+#ifndef _CHUNKEDINPUT_H_
+#define _CHUNKEDINPUT_H_
+
+#include <stdio.h>
+#include <stddef.h>
+
+/**
+Section: Definitions
+*/
+
+#define CHUNKED_INPUT_CHUNK_SIZE   (1 << 20)
+#define CHUNKED_INPUT_WINDOW       4  /**< Chunks in flight per worker */
+#define CHUNKED_INPUT_OUTPUT_LIMIT (64 << 20)  /**< Decoded output buffered by all chunks in flight */
+#define CHUNK_HANDLER_FAILED     (-2)  /**< A chunk handler failed, the output ends with what it wrote */
+
+/**
+Section: Public Types
+*/
+
+/**
+ * Decodes one chunk of whole lines and writes the result to output. Called
+ * from worker threads, concurrently for different chunks. Returns 0 on
+ * success; a negative value stops the input at this chunk, its output so
+ * far is still written but nothing behind it.
+ */
+typedef int (*ChunkHandler_t)(const char *data, size_t length, FILE *output, void *context);
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Maps a file and decodes it in chunks on several threads
+ *
+ * The file is split at line boundaries. Every chunk is handled with its own
+ * memory stream as output, the outputs are written to output in the order
+ * of the file. The number of chunks in flight is limited, and so is their
+ * buffered output: beyond CHUNKED_INPUT_OUTPUT_LIMIT a worker waits until
+ * its chunk is the next one to be written and then writes it to output
+ * directly. Memory use depends neither on the file size nor on the number
+ * of workers.
+ *
+ * Files that aren't regular files (FIFOs, /dev/stdin, process substitution)
+ * can't be mapped; they are read as a stream and decoded line by line on
+ * the calling thread.
+ *
+ * @param[in]  path     The file path
+ * @param[in]  workers  Number of worker threads; 1 decodes on the calling thread
+ * @param[in]  handler  The chunk handler
+ * @param      context  Passed to handler
+ * @param      output   Where the decoded chunks are written to
+ *
+ * @return     0 on success, CHUNK_HANDLER_FAILED if the handler failed and a negative value otherwise
+ */
+int ChunkedInput_ProcessFile(const char *path, unsigned int workers, ChunkHandler_t handler, void *context, FILE *output);
+
+#endif
@@ -0,0 +1,387 @@
+/**
+ * @file compressedInput.c
+ *
+ * gzip and zstd compressed log files, decompressed on their own thread
+ */
+
+/**
+Section: Included Files
+*/
+
+#define _GNU_SOURCE  /* memrchr() */
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include "compressedInput.h"
+#include "spscRing.h"
+
+/**
+Section: Definitions
+*/
+
+#define COMPRESSED_INPUT_MAX_STEP (1U << 30)  /* Input passed to zlib at once, its counters are 32 bit */
+
+/**
+Section: Private Types
+*/
+
+typedef enum
+{
+	COMPRESSION_NONE = 0,
+	COMPRESSION_GZIP,
+	COMPRESSION_ZSTD
+} Compression_t;
+
+typedef struct
+{
+	char *data;
+	size_t length;
+	size_t size;
+} CompressedInput_Buffer_t;
+
+typedef struct
+{
+	const unsigned char *data;  /**< The mapped compressed file */
+	size_t size;
+	Compression_t compression;
+
+	SpscRing_t freeBuffers;   /**< Parser to decompressor */
+	SpscRing_t fullBuffers;   /**< Decompressor to parser, NULL ends the input */
+	CompressedInput_Buffer_t *current;
+	int failed;
+	atomic_int stopped;       /**< The handler failed, the rest of the file isn't needed */
+} CompressedInput_t;
+
+/**
+Section: Private functions
+*/
+
+static Compression_t CompressedInput_Detect(const unsigned char *data, size_t size)
+{
+	static const unsigned char gzipMagic[] = { 0x1F, 0x8B };
+	static const unsigned char zstdMagic[] = { 0x28, 0xB5, 0x2F, 0xFD };
+
+	if (size >= sizeof(gzipMagic) && 0 == memcmp(data, gzipMagic, sizeof(gzipMagic)))
+	{
+		return COMPRESSION_GZIP;
+	}
+	if (size >= sizeof(zstdMagic) && 0 == memcmp(data, zstdMagic, sizeof(zstdMagic)))
+	{
+		return COMPRESSION_ZSTD;
+	}
+
+	return COMPRESSION_NONE;
+}
+
+/**
+ * @brief      Hands the whole lines of the current buffer to the parser and continues in a free buffer
+ *
+ * A line that doesn't fit into an empty buffer makes the buffer grow, the
+ * buffer that continues after it is grown to the same size.
+ *
+ * @return     0 on success and a negative value otherwise or if the parser stopped
+ */
+static int CompressedInput_Flush(CompressedInput_t *input)
+{
+	CompressedInput_Buffer_t *current = input->current, *next;
+	const char *newline;
+	char *data;
+
+	if (atomic_load_explicit(&input->stopped, memory_order_relaxed))
+	{
+		return -1;
+	}
+
+	newline = memrchr(current->data, '\n', current->length);
+	if (NULL == newline)
+	{
+		data = realloc(current->data, current->size * 2);
+		if (NULL == data)
+		{
+			return -1;
+		}
+		current->data = data;
+		current->size *= 2;
+		return 0;
+	}
+
+	/* The incomplete line may have made the current buffer grow, continue with the same size */
+	next = SpscRing_PopWait(&input->freeBuffers);
+	if (next->size < current->size)
+	{
+		data = realloc(next->data, current->size);
+		if (NULL == data)
+		{
+			/* The buffer is freed with the others, it doesn't need to go back to the ring */
+			return -1;
+		}
+		next->data = data;
+		next->size = current->size;
+	}
+	next->length = current->length - (newline + 1 - current->data);
+	memcpy(next->data, newline + 1, next->length);
+	current->length -= next->length;
+
+	SpscRing_PushWait(&input->fullBuffers, current);
+	input->current = next;
+
+	return 0;
+}
+
+#ifdef HAVE_ZLIB
+static int CompressedInput_Gunzip(CompressedInput_t *input)
+{
+	const unsigned char *in = input->data, *end = input->data + input->size;
+	z_stream stream;
+	int ret;
+
+	memset(&stream, 0, sizeof(stream));
+	/* gzip header detection */
+	if (Z_OK != inflateInit2(&stream, 15 + 32))
+	{
+		return -1;
+	}
+
+	for (;;)
+	{
+		if (0 == stream.avail_in && in < end)
+		{
+			stream.next_in = (unsigned char *) in;
+			stream.avail_in = (end - in > COMPRESSED_INPUT_MAX_STEP) ? COMPRESSED_INPUT_MAX_STEP : end - in;
+			in += stream.avail_in;
+		}
+		if (input->current->length == input->current->size && CompressedInput_Flush(input))
+		{
+			ret = Z_MEM_ERROR;
+			break;
+		}
+		stream.next_out = (unsigned char *) input->current->data + input->current->length;
+		stream.avail_out = input->current->size - input->current->length;
+
+		ret = inflate(&stream, Z_NO_FLUSH);
+		input->current->length = input->current->size - stream.avail_out;
+		if (Z_STREAM_END == ret)
+		{
+			if (0 == stream.avail_in && in == end)
+			{
+				break;
+			}
+			/* Concatenated gzip members */
+			inflateReset(&stream);
+		}
+		else if ((Z_OK != ret && Z_BUF_ERROR != ret) || (Z_BUF_ERROR == ret && 0 == stream.avail_in && in == end))
+		{
+			/* Corrupt or truncated */
+			break;
+		}
+	}
+
+	inflateEnd(&stream);
+	return (Z_STREAM_END == ret) ? 0 : -1;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+static int CompressedInput_Unzstd(CompressedInput_t *input)
+{
+	ZSTD_inBuffer in = { input->data, input->size, 0 };
+	ZSTD_outBuffer out;
+	ZSTD_DStream *stream;
+	size_t ret = 1;
+
+	stream = ZSTD_createDStream();
+	if (NULL == stream)
+	{
+		return -1;
+	}
+
+	/* Concatenated frames are decoded by the same stream */
+	while (in.pos < in.size || 0 != ret)
+	{
+		if (input->current->length == input->current->size && CompressedInput_Flush(input))
+		{
+			ret = 1;
+			break;
+		}
+		out.dst = input->current->data;
+		out.size = input->current->size;
+		out.pos = input->current->length;
+
+		ret = ZSTD_decompressStream(stream, &out, &in);
+		input->current->length = out.pos;
+		if (ZSTD_isError(ret) || (in.pos == in.size && 0 != ret && out.pos < out.size))
+		{
+			/* Corrupt or truncated */
+			ret = 1;
+			break;
+		}
+	}
+
+	ZSTD_freeDStream(stream);
+	return (0 == ret) ? 0 : -1;
+}
+#endif
+
+static void *CompressedInput_Decompress(void *arg)
+{
+	CompressedInput_t *input = arg;
+	int ret = -1;
+
+	input->current = SpscRing_PopWait(&input->freeBuffers);
+	input->current->length = 0;
+
+	switch (input->compression)
+	{
+#ifdef HAVE_ZLIB
+	case COMPRESSION_GZIP:
+		ret = CompressedInput_Gunzip(input);
+		break;
+#endif
+#ifdef HAVE_ZSTD
+	case COMPRESSION_ZSTD:
+		ret = CompressedInput_Unzstd(input);
+		break;
+#endif
+	default:
+		break;
+	}
+
+	/* The last line doesn't need a line end */
+	if (input->current->length > 0)
+	{
+		SpscRing_PushWait(&input->fullBuffers, input->current);
+	}
+	input->failed = ret;
+	SpscRing_PushWait(&input->fullBuffers, NULL);
+
+	return NULL;
+}
+
+/**
+Section: Implementation
+*/
+
+int CompressedInput_ProcessFile(const char *path, ChunkHandler_t handler, void *context, FILE *output)
+{
+	CompressedInput_Buffer_t buffers[COMPRESSED_INPUT_BUFFERS], *buffer;
+	CompressedInput_t input;
+	pthread_t thread;
+	struct stat st;
+	unsigned int i;
+	void *map;
+	int fd, ret = 0;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return -1;
+	}
+	if (fstat(fd, &st) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	if (0 == st.st_size)
+	{
+		close(fd);
+		return COMPRESSED_INPUT_NONE;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == map)
+	{
+		return -1;
+	}
+
+	memset(&input, 0, sizeof(input));
+	atomic_init(&input.stopped, 0);
+	input.data = map;
+	input.size = st.st_size;
+	input.compression = CompressedInput_Detect(input.data, input.size);
+	if (COMPRESSION_NONE == input.compression)
+	{
+		munmap(map, st.st_size);
+		return COMPRESSED_INPUT_NONE;
+	}
+#ifndef HAVE_ZLIB
+	if (COMPRESSION_GZIP == input.compression)
+	{
+		fprintf(stderr, "[ERROR] %s is gzip compressed, which this build doesn't support\n", path);
+		munmap(map, st.st_size);
+		return -1;
+	}
+#endif
+#ifndef HAVE_ZSTD
+	if (COMPRESSION_ZSTD == input.compression)
+	{
+		fprintf(stderr, "[ERROR] %s is zstd compressed, which this build doesn't support\n", path);
+		munmap(map, st.st_size);
+		return -1;
+	}
+#endif
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	/* Every buffer fits into either ring, so pushes never wait for the parser itself */
+	if (SpscRing_Init(&input.freeBuffers, COMPRESSED_INPUT_BUFFERS) || SpscRing_Init(&input.fullBuffers, COMPRESSED_INPUT_BUFFERS + 1))
+	{
+		SpscRing_DeInit(&input.freeBuffers);
+		munmap(map, st.st_size);
+		return -1;
+	}
+	for (i = 0; i < COMPRESSED_INPUT_BUFFERS; i++)
+	{
+		buffers[i].size = COMPRESSED_INPUT_BUFFER_SIZE;
+		buffers[i].length = 0;
+		buffers[i].data = malloc(buffers[i].size);
+		if (NULL == buffers[i].data)
+		{
+			ret = -1;
+		}
+		SpscRing_Push(&input.freeBuffers, &buffers[i]);
+	}
+
+	if (0 == ret && 0 == pthread_create(&thread, NULL, CompressedInput_Decompress, &input))
+	{
+		while (NULL != (buffer = SpscRing_PopWait(&input.fullBuffers)))
+		{
+			/* Buffers behind a failed one are dropped until the decompressor stops */
+			if (0 == ret && handler(buffer->data, buffer->length, output, context))
+			{
+				ret = CHUNK_HANDLER_FAILED;
+				atomic_store_explicit(&input.stopped, 1, memory_order_relaxed);
+			}
+			SpscRing_PushWait(&input.freeBuffers, buffer);
+		}
+		pthread_join(thread, NULL);
+		if (0 == ret)
+		{
+			ret = input.failed;
+		}
+	}
+	else
+	{
+		ret = -1;
+	}
+
+	for (i = 0; i < COMPRESSED_INPUT_BUFFERS; i++)
+	{
+		free(buffers[i].data);
+	}
+	SpscRing_DeInit(&input.freeBuffers);
+	SpscRing_DeInit(&input.fullBuffers);
+	munmap(map, st.st_size);
+
+	return ret;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file compressedInput.h
+ *
+ * gzip and zstd compressed log files, decompressed on their own thread
+ */
+
+#ifndef _COMPRESSEDINPUT_H_
+#define _COMPRESSEDINPUT_H_
+
+#include <stdio.h>
+#include "chunkedInput.h"
+
+/**
+Section: Definitions
+*/
+
+#define COMPRESSED_INPUT_BUFFER_SIZE (1 << 20)
+#define COMPRESSED_INPUT_BUFFERS     4  /**< Buffers shared by the decompressor and the parser */
+#define COMPRESSED_INPUT_NONE        1  /**< CompressedInput_ProcessFile(): the file isn't compressed */
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Decompresses a gzip or zstd file and decodes it
+ *
+ * The file is recognized by its magic number. A dedicated thread
+ * decompresses it into buffers of whole lines, which are passed to handler
+ * on the calling thread in file order.
+ *
+ * @param[in]  path     The file path
+ * @param[in]  handler  The chunk handler
+ * @param      context  Passed to handler
+ * @param      output   Passed to handler
+ *
+ * @return     0 on success, COMPRESSED_INPUT_NONE if the file isn't compressed, CHUNK_HANDLER_FAILED
+ *             if the handler failed and a negative value otherwise
+ */
+int CompressedInput_ProcessFile(const char *path, ChunkHandler_t handler, void *context, FILE *output);
+
+#endif
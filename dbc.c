@@ -9,11 +9,94 @@ Section: Included Files
 */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <ctype.h>
+#include <math.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
 
 #include "dbc.h"
+#include "dbcCache.h"
+
+/**
+Section: Private Definitions
+*/
+
+#define DBC_NONE UINT32_MAX  /**< End of an index list */
+
+#define DBC_READ_SIZE 65536  /**< First buffer for DBC files of unknown size, e.g. pipes */
+
+/** Size rounded up to the alignment of all objects in the database block */
+#define DBC_ALIGN(size) (((size) + 15) & ~(size_t) 15)
+
+/**
+Section: Private Types
+*/
+
+/**
+ * Position in the DBC file contents, which are NUL terminated
+ */
+typedef struct
+{
+    const char *p;
+    const char *end;
+    unsigned int line;  /**< Line of the current statement, for error messages */
+} Dbc_Tokenizer_t;
+
+typedef struct
+{
+    uint32_t name;         /**< Offset of the frame name in the string pool */
+    uint32_t firstSignal;  /**< Signals of the frame in DBC order, DBC_NONE if there are none */
+    uint32_t lastSignal;
+} Dbc_FrameInfo_t;
+
+typedef struct
+{
+    uint32_t name;  /**< Offsets in the string pool */
+    uint32_t unit;
+    uint32_t receiverList;
+    uint32_t nextSignal;  /**< Next signal of the same frame */
+} Dbc_SignalInfo_t;
+
+typedef struct
+{
+    uint32_t signal;    /**< Index of the signal */
+    uint32_t sequence;  /**< Order of definition, the last definition of a value wins */
+    int32_t value;
+    uint32_t name;      /**< Offset in the string pool */
+} Dbc_ValueInfo_t;
+
+/**
+ * Database under construction. The arrays grow while the DBC is parsed, so
+ * objects refer to each other by index and to strings by their offset in
+ * the string pool. Dbc_Finalize() copies everything into one block.
+ */
+typedef struct
+{
+    Dbc_Frame_t *frames;  /**< Pointers are set by Dbc_Finalize() */
+    Dbc_FrameInfo_t *frameInfo;
+    uint32_t frameCount;
+    uint32_t frameCapacity;
+    uint32_t *frameIndex;  /**< Same as Dbc_Database_t.frameIndex */
+    uint32_t frameIndexMask;
+    Dbc_Signal_t *signals;  /**< Pointers are set by Dbc_Finalize() */
+    Dbc_SignalInfo_t *signalInfo;
+    uint32_t signalCount;
+    uint32_t signalCapacity;
+    Dbc_ValueInfo_t *values;
+    uint32_t valueCount;
+    uint32_t valueCapacity;
+    char *strings;  /**< Interned NUL terminated strings, starting with "" */
+    size_t stringsSize;
+    size_t stringsCapacity;
+    uint32_t *stringIndex;  /**< Open addressing hash of the strings: offset + 1, 0 if free */
+    uint32_t stringIndexMask;
+    uint32_t stringCount;
+    bool failed;  /**< Out of memory */
+} Dbc_Builder_t;
 
 /**
 Section: Private functions
@@ -33,368 +116,1419 @@ Section: Private functions
  */
 static int Dbc_ProcessStartBit(int byteOrder, int startBit, int signalLength);
 
+/**
+ * @brief      Builds the decode plan of a frame from its signals
+ *
+ * @param      frame  The frame, muxPageCount pages are reserved if it has a multiplexer
+ * @param      steps  Room for one step per signal, zeroed
+ * @param      pages  Room for muxPageCount pages, zeroed
+ */
+static void Dbc_CompilePlan(Dbc_Frame_t *frame, Dbc_DecodeStep_t *steps, Dbc_MuxPage_t *pages);
+
+/**
+ * @brief      Selects the cheapest exact scaling class of a signal
+ *
+ * @param[in]  signal  The signal
+ *
+ * @return     The scaling class
+ */
+static Dbc_Scale_t Dbc_ClassifyScale(const Dbc_Signal_t *signal);
+
+/**
+ * @brief      Fills the dense value string table of a signal if the VAL_ range is small
+ *
+ * @param      signal  The signal
+ * @param      table   Room for Dbc_DenseTableLength() entries
+ */
+static void Dbc_CompileValueTable(Dbc_Signal_t *signal, const char **table);
+
 /**
 Section: Implementation
 */
 
-void Dbc_AddFrame(Dbc_Frame_t **db, canid_t canID, uint8_t dlc, char *frameName)
+static uint32_t Dbc_HashId(canid_t canID)
+{
+    /* Mixes the high bits into the low ones, so the hash can be masked */
+    canID ^= canID >> 16;
+    canID *= 0x45d9f3bU;
+    canID ^= canID >> 16;
+
+    return canID;
+}
+
+static uint32_t Dbc_HashString(const char *s, size_t length)
 {
-    Dbc_Frame_t *s;
+    uint32_t hash = 2166136261U;
 
-    s = malloc(sizeof(Dbc_Frame_t));
-    s->canID = canID;
-    s->dlc = dlc;
-    s->signals = NULL;
-    strncpy(s->name, frameName, DBC_MAX_FRAME_NAME);
-    s->name[DBC_MAX_FRAME_NAME - 1] = '\0';
-    s->isMultiplexed = 0;
+    while (length-- > 0)
+    {
+        hash = (hash ^ (uint8_t) *s++) * 16777619U;
+    }
 
-    HASH_ADD_INT(*db, canID, s);
+    return hash;
 }
 
-Dbc_Frame_t *Dbc_FindFrame(Dbc_Frame_t *frame_list, canid_t canID)
+/* Adds a frame to an index with room for it, replacing an earlier frame with the same ID */
+static void Dbc_IndexFrame(const Dbc_Frame_t *frames, uint32_t *index, uint32_t mask, uint32_t frame)
 {
-    Dbc_Frame_t *s;
-    HASH_FIND_INT(frame_list, &canID, s);
-    return s;
+    uint32_t slot = Dbc_HashId(frames[frame].canID) & mask;
+
+    while (0 != index[slot] && frames[index[slot] - 1].canID != frames[frame].canID)
+    {
+        slot = (slot + 1) & mask;
+    }
+    index[slot] = frame + 1;
 }
 
-Dbc_Frame_t *Dbc_FindFrameByName(Dbc_Frame_t *frame_list, char *name)
+static Dbc_Frame_t *Dbc_LookupFrame(Dbc_Frame_t *frames, const uint32_t *index, uint32_t mask, canid_t key)
 {
-    Dbc_Frame_t *s;
+    uint32_t slot;
 
-    for(s=frame_list; s != NULL; s=s->hh.next)
+    for (slot = Dbc_HashId(key) & mask; 0 != index[slot]; slot = (slot + 1) & mask)
     {
-        if(!strcmp(s->name, name))
+        if (frames[index[slot] - 1].canID == key)
         {
-            return s;
+            return &frames[index[slot] - 1];
         }
     }
 
     return NULL;
 }
 
-Dbc_Frame_t *Dbc_FindFrameBySignalname(Dbc_Frame_t *frame_list, char *name)
+Dbc_Frame_t *Dbc_FindFrame(const Dbc_Database_t *db, canid_t canID)
 {
-    Dbc_Frame_t *frame;
-    Dbc_Signal_t *sig;
+    if (NULL == db)
+    {
+        return NULL;
+    }
+
+    return Dbc_LookupFrame(db->frames, db->frameIndex, db->frameIndexMask, Dbc_NormalizeId(canID));
+}
+
+Dbc_Frame_t *Dbc_FindFrameByName(const Dbc_Database_t *db, const char *name)
+{
+    uint32_t slot;
+
+    if (NULL == db)
+    {
+        return NULL;
+    }
 
-    for (frame=frame_list; frame != NULL; frame=frame->hh.next)
+    for (slot = Dbc_HashString(name, strlen(name)) & db->frameIndexMask; 0 != db->frameNameIndex[slot];
+        slot = (slot + 1) & db->frameIndexMask)
     {
-        for (sig=frame->signals; sig != NULL; sig = sig->hh.next)
+        if (!strcmp(db->frames[db->frameNameIndex[slot] - 1].name, name))
         {
-            if(!strcmp(sig->name, name))
-            {
-                return frame;
-            }
+            return &db->frames[db->frameNameIndex[slot] - 1];
         }
     }
 
     return NULL;
 }
 
-Dbc_Signal_t *Dbc_FindSignalByName(Dbc_Frame_t *frame, char *name)
+Dbc_Frame_t *Dbc_FindFrameBySignalname(const Dbc_Database_t *db, const char *name)
 {
-    Dbc_Signal_t *sig;
+    unsigned int i;
 
-    for(sig=frame->signals; sig != NULL; sig = sig->hh.next)
+    for (i = 0; NULL != db && i < db->frameCount; i++)
     {
-        if(!strcmp(sig->name, name))
+        if (NULL != Dbc_FindSignalByName(&db->frames[i], name))
         {
-            return sig;
+            return &db->frames[i];
         }
     }
 
     return NULL;
 }
 
-const char *Dbc_FindValueString(Dbc_Signal_t *signal, int32_t value)
+Dbc_Signal_t *Dbc_FindSignalByName(const Dbc_Frame_t *frame, const char *name)
 {
-    Dbc_Value_t *v;
-    HASH_FIND_INT(signal->values, &value, v);
-    if (NULL == v)
+    uint32_t slot;
+
+    if (NULL == frame->signalIndex)
     {
         return NULL;
     }
 
-    return v->name;
+    for (slot = Dbc_HashString(name, strlen(name)) & frame->signalIndexMask; 0 != frame->signalIndex[slot];
+        slot = (slot + 1) & frame->signalIndexMask)
+    {
+        if (!strcmp(frame->signals[frame->signalIndex[slot] - 1].name, name))
+        {
+            return &frame->signals[frame->signalIndex[slot] - 1];
+        }
+    }
+
+    return NULL;
 }
 
-void Dbc_AddSignal(
-    Dbc_Frame_t *frame_list, int32_t frameId,
-    char *signalName, int startBit, int signalLength,
-    int is_big_endian, int signedState,
-    float factor, float offset, float min, float max,
-    char *unit,
-    char *receiverList,
-    uint8_t isMultiplexer, uint8_t muxId)
+bool Dbc_IsPattern(const char *selector)
 {
-    Dbc_Frame_t *frame;
-    Dbc_Signal_t *newSignal;
-
-    frame = Dbc_FindFrame(frame_list, frameId);
-
-    newSignal = malloc(sizeof(Dbc_Signal_t));
-    strncpy(newSignal->name, signalName, DBC_MAX_SIGNAL_NAME);
-    newSignal->name[DBC_MAX_SIGNAL_NAME - 1] = '\0';
+    return NULL != strpbrk(selector, "*?[\\");
+}
 
-    newSignal->startBit = startBit;
-    newSignal->signalLength = signalLength;
-    newSignal->is_big_endian = is_big_endian;
-    newSignal->is_signed = signedState;
-    newSignal->factor = factor;
-    newSignal->offset = offset;
-    newSignal->min = min;
-    newSignal->max = max;
-    newSignal->values = NULL;
+/* Calls handler for the selected signals of one frame */
+static unsigned int Dbc_SelectSignals(Dbc_Frame_t *frame, const char *signalSelector, Dbc_SelectHandler_t handler, void *context)
+{
+    Dbc_Signal_t *signal;
+    unsigned int count = 0;
 
-    if(isMultiplexer > 0)
+    if (NULL == signalSelector)
     {
-        frame->isMultiplexed = 1;
+        handler(frame, NULL, context);
+        return 1;
     }
-    newSignal->isMultiplexer = isMultiplexer;
-    newSignal->muxId = muxId;
 
-    strncpy(newSignal->unit, unit, DBC_MAX_UNIT_NAME);
-    newSignal->unit[DBC_MAX_UNIT_NAME - 1] = '\0';
+    if (!Dbc_IsPattern(signalSelector))
+    {
+        signal = Dbc_FindSignalByName(frame, signalSelector);
+        if (NULL != signal)
+        {
+            handler(frame, signal, context);
+            count++;
+        }
+        return count;
+    }
 
-    strncpy(newSignal->receiverList, receiverList, DBC_MAX_RECEIVER_LIST);
-    newSignal->receiverList[DBC_MAX_RECEIVER_LIST - 1] = '\0';
+    for (signal = frame->signals; signal < frame->signals + frame->signalCount; signal++)
+    {
+        if (0 == fnmatch(signalSelector, signal->name, 0))
+        {
+            handler(frame, signal, context);
+            count++;
+        }
+    }
 
-    HASH_ADD_STR(frame->signals, name, newSignal);
+    return count;
 }
 
-static int Dbc_ProcessStartBit(int byteOrder, int startBit, int signalLength)
+unsigned int Dbc_Select(const Dbc_Database_t *db, const char *frameSelector, const char *signalSelector,
+    Dbc_SelectHandler_t handler, void *context)
 {
-    if (byteOrder == DBC_BO_BIG_ENDIAN)
+    Dbc_Frame_t *frame;
+    unsigned int count = 0;
+
+    if (NULL == db)
     {
-        int pos = 7 - (startBit % 8) + (signalLength - 1);
-        if (pos < 8)
+        return 0;
+    }
+
+    if (!Dbc_IsPattern(frameSelector))
+    {
+        frame = Dbc_FindFrameByName(db, frameSelector);
+        return (NULL != frame) ? Dbc_SelectSignals(frame, signalSelector, handler, context) : 0;
+    }
+
+    for (frame = db->frames; frame < db->frames + db->frameCount; frame++)
+    {
+        if (0 == fnmatch(frameSelector, frame->name, 0))
         {
-            startBit = startBit - signalLength + 1;
+            count += Dbc_SelectSignals(frame, signalSelector, handler, context);
         }
-        else
+    }
+
+    return count;
+}
+
+Dbc_DecodeStep_t *Dbc_FindDecodeStep(Dbc_Frame_t *frame, Dbc_Signal_t *signal)
+{
+    unsigned int i;
+
+    /* Multiplexer pages may end with unused steps of length 0 */
+    for (i = 0; i < frame->planLength; i++)
+    {
+        if (0 != frame->plan[i].length && &frame->signals[frame->plan[i].signal] == signal)
         {
-            int cpos = 7 - (pos % 8);
-            int bytes = (int) (pos / 8);
-            startBit = cpos + (bytes * 8) + (int) (startBit / 8) * 8;
+            return &frame->plan[i];
         }
     }
 
-    return startBit;
+    return NULL;
 }
 
-static void Dbc_ParseValues(Dbc_Frame_t **db, char *line)
+const char *Dbc_FindValueString(const Dbc_Signal_t *signal, int32_t value)
 {
-    Dbc_Frame_t *frame;
-    Dbc_Signal_t *signal;
+    uint32_t index, low = 0, high = signal->valueCount, middle;
 
-    char *savePtr;
-    /* Extract frame id */
-    char *frameIdStr = strtok_r(&line[5], " \r\n", &savePtr);
-    int frameId;
-    int ret = sscanf(frameIdStr, "%d", &frameId);
-    if (1 != ret)
+    if (NULL != signal->valueTable)
     {
-        fprintf(stderr, "Failed to read frame id: %s\n", frameIdStr);
-        return;
+        index = (uint32_t) value - (uint32_t) signal->valueMin;
+        return (index < signal->valueTableLength) ? signal->valueTable[index] : NULL;
     }
 
-    /* Find the frame */
-    frame = Dbc_FindFrame(*db, frameId);
-    if (NULL == frame)
+    /* Sparse values are sorted */
+    while (low < high)
     {
-        fprintf(stderr, "Failed to find a frame with id: %d\n", frameId);
-        return;
+        middle = low + (high - low) / 2;
+        if (signal->values[middle].value < value)
+        {
+            low = middle + 1;
+        }
+        else if (signal->values[middle].value > value)
+        {
+            high = middle;
+        }
+        else
+        {
+            return signal->values[middle].name;
+        }
     }
 
-    /* Extract signal name */
-    char *signalName = strtok_r(NULL, " \r\n", &savePtr);
-    /* Find the signal */
-    signal = Dbc_FindSignalByName(frame, signalName);
+    return NULL;
+}
 
-    char *token = signalName;
+/* Grows an array of the builder, flags the builder on failure */
+static bool Dbc_Resize(Dbc_Builder_t *builder, void **array, size_t count, size_t size)
+{
+    void *newArray = realloc(*array, count * size);
 
-    for (;;)
+    if (NULL == newArray)
+    {
+        builder->failed = true;
+        return false;
+    }
+    *array = newArray;
+
+    return true;
+}
+
+/**
+ * @brief      Adds a string to the string pool unless it's already there
+ *
+ * @return     Offset of the string in the pool, 0 ("") if out of memory
+ */
+static uint32_t Dbc_Intern(Dbc_Builder_t *builder, const char *s, size_t length)
+{
+    uint32_t slot, offset, i, size;
+    uint32_t *index;
+
+    /* Keep the index at most half full */
+    if (2 * (builder->stringCount + 1) > builder->stringIndexMask + 1)
     {
-        /* Find numeric value */
-        token = strtok_r(NULL, " \r\n", &savePtr);
-        if (NULL == token)
+        size = builder->stringIndex ? 2 * (builder->stringIndexMask + 1) : 1024;
+        index = calloc(size, sizeof(uint32_t));
+        if (NULL == index)
         {
-            /* No more values present, stop here */
-            break;
+            builder->failed = true;
+            return 0;
         }
-        if (';' == *token)
+        for (i = 0; i <= builder->stringIndexMask && NULL != builder->stringIndex; i++)
         {
-            /* Line terminator found, stop here */
-            break;
+            if (0 != builder->stringIndex[i])
+            {
+                offset = builder->stringIndex[i] - 1;
+                slot = Dbc_HashString(builder->strings + offset, strlen(builder->strings + offset)) & (size - 1);
+                while (0 != index[slot])
+                {
+                    slot = (slot + 1) & (size - 1);
+                }
+                index[slot] = offset + 1;
+            }
         }
-        int value;
-        ret = sscanf(token, "%d", &value);
-        if (1 != ret)
+        free(builder->stringIndex);
+        builder->stringIndex = index;
+        builder->stringIndexMask = size - 1;
+    }
+
+    for (slot = Dbc_HashString(s, length) & builder->stringIndexMask; 0 != builder->stringIndex[slot];
+         slot = (slot + 1) & builder->stringIndexMask)
+    {
+        offset = builder->stringIndex[slot] - 1;
+        if (0 == memcmp(builder->strings + offset, s, length) && '\0' == builder->strings[offset + length])
         {
-            fprintf(stderr, "Failed to parse value: '%s'\n", token);
-            return;
+            return offset;
         }
+    }
 
-        /* Find string value */
-        token = strtok_r(NULL, "\"", &savePtr);
-        if (NULL == token)
+    if (builder->stringsSize + length + 1 > builder->stringsCapacity)
+    {
+        size_t capacity = builder->stringsCapacity ? builder->stringsCapacity : 4096;
+        while (builder->stringsSize + length + 1 > capacity)
         {
-            fprintf(stderr, "Failed to find a string token\n");
-            return;
+            capacity *= 2;
         }
-
-        /* Check is the token composed solely of space characters */
-        bool spaces_only = true;
-        const char *c = token;
-        while (*c)
+        if (capacity > UINT32_MAX || !Dbc_Resize(builder, (void **) &builder->strings, capacity, 1))
         {
-            if (!isblank(*c))
-            {
-                spaces_only = false;
-                break;
-            }
-            c++;
+            builder->failed = true;
+            return 0;
         }
+        builder->stringsCapacity = capacity;
+    }
+
+    offset = builder->stringsSize;
+    memcpy(builder->strings + offset, s, length);
+    builder->strings[offset + length] = '\0';
+    builder->stringsSize += length + 1;
+    builder->stringIndex[slot] = offset + 1;
+    builder->stringCount++;
+
+    return offset;
+}
+
+static uint32_t Dbc_BuilderFindFrame(const Dbc_Builder_t *builder, canid_t canID)
+{
+    Dbc_Frame_t *frame;
+
+    if (NULL == builder->frameIndex)
+    {
+        return DBC_NONE;
+    }
+    frame = Dbc_LookupFrame(builder->frames, builder->frameIndex, builder->frameIndexMask, Dbc_NormalizeId(canID));
 
-        /* Ignore the token with spaces only */
-        if (spaces_only)
+    return (NULL != frame) ? (uint32_t) (frame - builder->frames) : DBC_NONE;
+}
+
+static uint32_t Dbc_BuilderFindSignal(const Dbc_Builder_t *builder, uint32_t frame, uint32_t name)
+{
+    uint32_t signal;
+
+    /* Interned names are equal if their offsets are */
+    for (signal = builder->frameInfo[frame].firstSignal; DBC_NONE != signal; signal = builder->signalInfo[signal].nextSignal)
+    {
+        if (builder->signalInfo[signal].name == name)
         {
-            token = strtok_r(NULL, "\"", &savePtr);
-            if (NULL == token)
-            {
-                fprintf(stderr, "Failed to find a string token\n");
-                return;
-            }
+            return signal;
         }
+    }
 
-        Dbc_Value_t *newValue = malloc(sizeof(Dbc_Value_t));
-        strncpy(newValue->name, token, DBC_MAX_VALUE_NAME);
-        newValue->name[DBC_MAX_VALUE_NAME - 1] = '\0';
-        newValue->value = value;
+    return DBC_NONE;
+}
 
-        HASH_ADD_INT(signal->values, value, newValue);
+static void Dbc_AddFrame(Dbc_Builder_t *builder, canid_t canID, uint8_t dlc, const char *frameName, size_t nameLength)
+{
+    Dbc_Frame_t *frame;
+    Dbc_FrameInfo_t *info;
+    uint32_t capacity, size, i;
+    uint32_t *index;
 
-        const int len = strlen(newValue->name);
-        if (';' == newValue->name[len - 1])
+    if (builder->frameCount == builder->frameCapacity)
+    {
+        capacity = builder->frameCapacity ? 2 * builder->frameCapacity : 64;
+        if (!Dbc_Resize(builder, (void **) &builder->frames, capacity, sizeof(Dbc_Frame_t)) ||
+            !Dbc_Resize(builder, (void **) &builder->frameInfo, capacity, sizeof(Dbc_FrameInfo_t)))
         {
-            /* If we found a ';' symbol at the end - strip it and stop here */
-            newValue->name[len - 1] = '\0';
-            break;
+            return;
+        }
+        builder->frameCapacity = capacity;
+    }
+
+    /* Keep the index at most half full */
+    if (2 * (builder->frameCount + 1) > builder->frameIndexMask + 1)
+    {
+        size = builder->frameIndex ? 2 * (builder->frameIndexMask + 1) : 128;
+        index = calloc(size, sizeof(uint32_t));
+        if (NULL == index)
+        {
+            builder->failed = true;
+            return;
         }
+        for (i = 0; i < builder->frameCount; i++)
+        {
+            Dbc_IndexFrame(builder->frames, index, size - 1, i);
+        }
+        free(builder->frameIndex);
+        builder->frameIndex = index;
+        builder->frameIndexMask = size - 1;
     }
+
+    frame = &builder->frames[builder->frameCount];
+    memset(frame, 0, sizeof(Dbc_Frame_t));
+    frame->canID = Dbc_NormalizeId(canID);
+    frame->dlc = dlc;
+
+    info = &builder->frameInfo[builder->frameCount];
+    info->name = Dbc_Intern(builder, frameName, nameLength);
+    info->firstSignal = DBC_NONE;
+    info->lastSignal = DBC_NONE;
+
+    Dbc_IndexFrame(builder->frames, builder->frameIndex, builder->frameIndexMask, builder->frameCount);
+    builder->frameCount++;
 }
 
-int32_t Dbc_Init(Dbc_Frame_t **db, char *dbcFilePath)
+static void Dbc_AddSignal(Dbc_Builder_t *builder, canid_t frameId, const Dbc_Signal_t *signal, const Dbc_SignalInfo_t *signalInfo)
 {
-    char line[DBC_MAX_LINE_SIZE];
-    char frameName[DBC_MAX_FRAME_NAME], sender[DBC_MAX_SENDER_NAME];
-    char signalName[DBC_MAX_SIGNAL_NAME], unit[DBC_MAX_UNIT_NAME], receiverList[DBC_MAX_RECEIVER_LIST];
-    char signedState;
+    Dbc_FrameInfo_t *frameInfo;
+    uint32_t frame, capacity;
 
-    int startBit = 0, signalLength = 0, byteOrder = 0;
-    float factor = 0., offset = 0., min = 0., max = 0.;
-    char mux[DBC_MAX_MUXLEN];
-    uint8_t muxId = 0, isMultiplexer = 0;
-    int frameId = 0, frameDlc, signalFound = 0, ret;
+    frame = Dbc_BuilderFindFrame(builder, frameId);
+    if (DBC_NONE == frame)
+    {
+        fprintf(stderr, "Failed to find a frame with id: %u\n", frameId);
+        return;
+    }
 
-    FILE *fp = fopen(dbcFilePath, "r");
-    if(NULL == fp)
+    if (builder->signalCount == builder->signalCapacity)
     {
-        fprintf(stderr, "Error opening %s\n", dbcFilePath);
-        return -1;
+        capacity = builder->signalCapacity ? 2 * builder->signalCapacity : 256;
+        if (!Dbc_Resize(builder, (void **) &builder->signals, capacity, sizeof(Dbc_Signal_t)) ||
+            !Dbc_Resize(builder, (void **) &builder->signalInfo, capacity, sizeof(Dbc_SignalInfo_t)))
+        {
+            return;
+        }
+        builder->signalCapacity = capacity;
+    }
+
+    if (signal->isMultiplexer > 0)
+    {
+        builder->frames[frame].isMultiplexed = 1;
+    }
+    builder->signals[builder->signalCount] = *signal;
+    builder->signalInfo[builder->signalCount] = *signalInfo;
+    builder->signalInfo[builder->signalCount].nextSignal = DBC_NONE;
+
+    frameInfo = &builder->frameInfo[frame];
+    if (DBC_NONE == frameInfo->lastSignal)
+    {
+        frameInfo->firstSignal = builder->signalCount;
+    }
+    else
+    {
+        builder->signalInfo[frameInfo->lastSignal].nextSignal = builder->signalCount;
     }
+    frameInfo->lastSignal = builder->signalCount;
+    builder->signalCount++;
+}
 
-    while(fgets(line, DBC_MAX_LINE_SIZE - 1, fp))
+static void Dbc_AddValue(Dbc_Builder_t *builder, uint32_t signal, int32_t value, const char *name, size_t nameLength)
+{
+    Dbc_ValueInfo_t *info;
+    uint32_t capacity;
+
+    if (builder->valueCount == builder->valueCapacity)
     {
-        /* Search for frames */
-        if(sscanf(line, "BO_ %d %s %d %s", &frameId, frameName, &frameDlc, sender) == 4)
+        capacity = builder->valueCapacity ? 2 * builder->valueCapacity : 256;
+        if (!Dbc_Resize(builder, (void **) &builder->values, capacity, sizeof(Dbc_ValueInfo_t)))
         {
-            frameName[strlen(frameName) - 1] = '\0';  /* Remove last character ':' */
-            Dbc_AddFrame(db, frameId, frameDlc, frameName);
+            return;
         }
-        /* Search for values */
-        else if (strncmp(line, "VAL_ ", 5) == 0)
+        builder->valueCapacity = capacity;
+    }
+
+    info = &builder->values[builder->valueCount];
+    info->signal = signal;
+    info->sequence = builder->valueCount;
+    info->value = value;
+    info->name = Dbc_Intern(builder, name, nameLength);
+    builder->valueCount++;
+}
+
+static void Dbc_FreeBuilder(Dbc_Builder_t *builder)
+{
+    free(builder->frames);
+    free(builder->frameInfo);
+    free(builder->frameIndex);
+    free(builder->signals);
+    free(builder->signalInfo);
+    free(builder->values);
+    free(builder->strings);
+    free(builder->stringIndex);
+}
+
+static int Dbc_ProcessStartBit(int byteOrder, int startBit, int signalLength)
+{
+    if (byteOrder == DBC_BO_BIG_ENDIAN)
+    {
+        int pos = 7 - (startBit % 8) + (signalLength - 1);
+        if (pos < 8)
         {
-            Dbc_ParseValues(db, line);
+            startBit = startBit - signalLength + 1;
         }
-        /* Search for signals */
         else
         {
-            signalFound = 0;
+            int cpos = 7 - (pos % 8);
+            int bytes = (int) (pos / 8);
+            startBit = cpos + (bytes * 8) + (int) (startBit / 8) * 8;
+        }
+    }
 
-            /* Check for a standard signal */
-            ret = sscanf(line, " SG_ %s : %d|%d@%d%c (%f,%f) [%f|%f] %s %s", 
-                signalName, &startBit, &signalLength, &byteOrder, &signedState, &factor, &offset, &min, &max, unit, receiverList );
-            if(ret > DBC_MIN_SIGNAL_SCAN)
-            {
-                signalFound = 1;
-                isMultiplexer = DBC_MUX_NONE;
-                muxId = 0;
-            }
-            else
-            {
-                /* Check for a multiplexed signal */
-                ret = sscanf(line, " SG_ %s %s : %d|%d@%d%c (%f,%f) [%f|%f] %s %s",
-                    signalName, mux, &startBit, &signalLength, &byteOrder, &signedState, &factor, &offset, &min, &max, unit, receiverList );
-                if(ret > DBC_MIN_SIGNAL_SCAN)
-                {
-                    signalFound = 1;
-
-                    if(mux[0] == 'M')
-                    {
-                        isMultiplexer = DBC_MUX_DEFINE;
-                        muxId = 0;
-                    }
-                    else if(mux[0] == 'm')
-                    {
-                        isMultiplexer = DBC_MUX_DATA;
-                        sscanf(mux, "m%hhu", &muxId);
-                    }
-                    else
-                    {
-                        /* Shouldn't be here */
-                        isMultiplexer = 0;
-                        muxId = 0;
-                    }
+    return startBit;
+}
 
-                }
-            }
+static Dbc_Scale_t Dbc_ClassifyScale(const Dbc_Signal_t *signal)
+{
+    int factorBits = 0;
+    double factor = fabs(signal->factor);
 
-            if (signalFound)
-            {
-                /* Add signal to frame */
-                startBit = Dbc_ProcessStartBit(byteOrder, startBit, signalLength);  /* Check for Big Endian */
-                Dbc_AddSignal(*db, frameId, signalName, startBit, signalLength, byteOrder == DBC_BO_BIG_ENDIAN, signedState == '-',
-                    factor, offset, min, max, unit, receiverList, isMultiplexer, muxId);
-            }
-        }
+    if (1. == signal->factor && 0. == signal->offset)
+    {
+        return DBC_SCALE_IDENTITY;
     }
 
-    fclose(fp);
-    return 0;
+    if (signal->factor != trunc(signal->factor) || signal->offset != trunc(signal->offset) ||
+        0. == signal->factor || fabs(signal->offset) >= 0x1p53)
+    {
+        return DBC_SCALE_GENERAL;
+    }
+
+    /* raw * factor must not overflow a signed 64 bit integer */
+    while (factor >= 1.)
+    {
+        factor /= 2.;
+        factorBits++;
+    }
+    if (signal->signalLength + factorBits > 62)
+    {
+        return DBC_SCALE_GENERAL;
+    }
+
+    return DBC_SCALE_INTEGER;
 }
 
-void Dbc_DeInit(Dbc_Frame_t *db)
+static bool Dbc_CompileStep(Dbc_Frame_t *frame, Dbc_Signal_t *signal, Dbc_DecodeStep_t *step)
 {
-    Dbc_Frame_t *frame, *frame_tmp;
-    Dbc_Signal_t *signal, *signal_tmp;
-    Dbc_Value_t *value, *value_tmp;
+    int firstByte, lastByte, payloadBytes, byteOffset;
 
-    HASH_ITER(hh, db, frame, frame_tmp)
+    /* startBit is the LSB position for both byte orders (see Dbc_ProcessStartBit) */
+    if (signal->is_big_endian)
     {
-        HASH_ITER(hh, frame->signals, signal, signal_tmp)
-        {
-            HASH_ITER(hh, signal->values, value, value_tmp)
-            {
-                HASH_DEL(signal->values, value);
-                free(value);
-            }
-            HASH_DEL(frame->signals, signal);
-            free(signal);
-        }
-        HASH_DEL(db, frame);
-        free(frame);
+        lastByte = signal->startBit / 8;
+        firstByte = lastByte - (signal->startBit % 8 + signal->signalLength - 1) / 8;
+    }
+    else
+    {
+        firstByte = signal->startBit / 8;
+        lastByte = (signal->startBit + signal->signalLength - 1) / 8;
+    }
+
+    /* Read an 8 byte window starting at the first byte, but within the payload */
+    payloadBytes = (frame->dlc > CAN_MAX_DLEN) ? CANFD_MAX_DLEN : CAN_MAX_DLEN;
+    byteOffset = (firstByte < payloadBytes - 8) ? firstByte : payloadBytes - 8;
+
+    if (signal->startBit < 0 || signal->signalLength < 1 || signal->signalLength > 64 ||
+        firstByte < 0 || lastByte >= payloadBytes || lastByte - byteOffset >= 8)
+    {
+        fprintf(stderr, "Signal %s.%s doesn't fit into the frame, it won't be decoded\n", frame->name, signal->name);
+        return false;
+    }
+    if (signal - frame->signals > UINT16_MAX)
+    {
+        fprintf(stderr, "Frame %s has too many signals, %s won't be decoded\n", frame->name, signal->name);
+        return false;
+    }
+
+    step->factor = signal->factor;
+    step->offset = signal->offset;
+    /* Motorola signals are read from the byte swapped payload, where byte 0 is the most significant */
+    step->byteOffset = byteOffset;
+    step->shift = signal->is_big_endian ? (7 - (signal->startBit / 8 - byteOffset)) * 8 + signal->startBit % 8 : signal->startBit - byteOffset * 8;
+    step->length = signal->signalLength;
+    step->flags = (Dbc_ClassifyScale(signal) << DBC_STEP_SCALE_SHIFT) |
+        (signal->is_big_endian ? DBC_STEP_BIG_ENDIAN : 0) |
+        (signal->is_signed ? DBC_STEP_SIGNED : 0) |
+        (signal->valueCount > 0 ? DBC_STEP_VALUES : 0) |
+        (DBC_MUX_DATA == signal->isMultiplexer ? DBC_STEP_MULTIPLEXED : 0);
+    step->muxId = signal->muxId;
+    step->signal = signal - frame->signals;
+
+    return true;
+}
+
+static void Dbc_CompilePlan(Dbc_Frame_t *frame, Dbc_DecodeStep_t *steps, Dbc_MuxPage_t *pages)
+{
+    Dbc_Signal_t *signal;
+    unsigned int i;
+
+    /* Zeroed, so steps of signals that fail to compile have length 0 */
+    frame->plan = steps;
+    frame->planLength = 0;
+
+    /* Multiplexer first */
+    for (signal = frame->signals; signal < frame->signals + frame->signalCount; signal++)
+    {
+        if (DBC_MUX_DEFINE == signal->isMultiplexer &&
+            Dbc_CompileStep(frame, signal, &frame->plan[frame->planLength]))
+        {
+            frame->muxStep = &frame->plan[frame->planLength++];
+            break;
+        }
+    }
+
+    /* Not multiplexed signals */
+    for (signal = frame->signals; signal < frame->signals + frame->signalCount; signal++)
+    {
+        if (DBC_MUX_NONE == signal->isMultiplexer &&
+            Dbc_CompileStep(frame, signal, &frame->plan[frame->planLength]))
+        {
+            frame->planLength++;
+        }
+    }
+    frame->staticLength = frame->planLength;
+
+    /* Multiplexed signals are only reachable through the multiplexer */
+    if (NULL == frame->muxStep)
+    {
+        frame->muxPageCount = 0;
+        return;
+    }
+    frame->muxPages = pages;
+
+    /* Reserve a contiguous range of steps for every multiplexer value */
+    for (signal = frame->signals; signal < frame->signals + frame->signalCount; signal++)
+    {
+        if (DBC_MUX_DATA == signal->isMultiplexer)
+        {
+            frame->muxPages[signal->muxId].count++;
+        }
+    }
+    for (i = 0; i < frame->muxPageCount; i++)
+    {
+        frame->muxPages[i].first = frame->planLength;
+        frame->planLength += frame->muxPages[i].count;
+        frame->muxPages[i].count = 0;
+    }
+
+    /* Fill the ranges, keeping DBC order within a page */
+    for (signal = frame->signals; signal < frame->signals + frame->signalCount; signal++)
+    {
+        if (DBC_MUX_DATA == signal->isMultiplexer)
+        {
+            Dbc_MuxPage_t *page = &frame->muxPages[signal->muxId];
+            if (Dbc_CompileStep(frame, signal, &frame->plan[page->first + page->count]))
+            {
+                page->count++;
+            }
+        }
+    }
+}
+
+/* Entries of a dense value table for sorted values from min to max, 0 if the table would be sparse */
+static uint32_t Dbc_DenseTableLength(int32_t min, int32_t max, uint32_t count)
+{
+    int64_t range = (int64_t) max - min + 1;
+
+    if (0 == count || (range > DBC_MAX_DENSE_VALUES && range > (int64_t) count * DBC_DENSE_VALUE_RATIO))
+    {
+        return 0;
+    }
+
+    return range;
+}
+
+static void Dbc_CompileValueTable(Dbc_Signal_t *signal, const char **table)
+{
+    uint32_t i;
+
+    if (0 == signal->valueCount)
+    {
+        return;
+    }
+
+    signal->valueMin = signal->values[0].value;
+    signal->valueTableLength = Dbc_DenseTableLength(signal->valueMin, signal->values[signal->valueCount - 1].value, signal->valueCount);
+    if (0 == signal->valueTableLength)
+    {
+        /* Sparse, values are found by a binary search */
+        return;
+    }
+
+    signal->valueTable = table;
+    for (i = 0; i < signal->valueCount; i++)
+    {
+        signal->valueTable[signal->values[i].value - signal->valueMin] = signal->values[i].name;
+    }
+}
+
+static void Dbc_SkipBlanks(Dbc_Tokenizer_t *t)
+{
+    while (t->p < t->end && (' ' == *t->p || '\t' == *t->p || '\r' == *t->p))
+    {
+        t->p++;
+    }
+}
+
+static void Dbc_SkipSpaces(Dbc_Tokenizer_t *t)
+{
+    while (t->p < t->end && isspace((unsigned char) *t->p))
+    {
+        t->p++;
+    }
+}
+
+static bool Dbc_AtLineEnd(Dbc_Tokenizer_t *t)
+{
+    Dbc_SkipBlanks(t);
+    return t->p == t->end || '\n' == *t->p;
+}
+
+static void Dbc_SkipLine(Dbc_Tokenizer_t *t)
+{
+    /* Quoted strings (e.g. comments) may span several lines */
+    while (t->p < t->end && '\n' != *t->p)
+    {
+        if ('"' == *t->p++)
+        {
+            while (t->p < t->end && '"' != *t->p)
+            {
+                t->p++;
+            }
+            if (t->p < t->end)
+            {
+                t->p++;
+            }
+        }
+    }
+    if (t->p < t->end)
+    {
+        t->p++;
+    }
+}
+
+static bool Dbc_Accept(Dbc_Tokenizer_t *t, char c)
+{
+    Dbc_SkipBlanks(t);
+    if (t->p < t->end && c == *t->p)
+    {
+        t->p++;
+        return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief      Reads a C identifier
+ *
+ * @return     Length of the identifier, 0 if there is none
+ */
+static size_t Dbc_Identifier(Dbc_Tokenizer_t *t, const char **start)
+{
+    Dbc_SkipBlanks(t);
+    *start = t->p;
+    while (t->p < t->end && (isalnum((unsigned char) *t->p) || '_' == *t->p))
+    {
+        t->p++;
+    }
+
+    return t->p - *start;
+}
+
+static bool Dbc_Long(Dbc_Tokenizer_t *t, long *value)
+{
+    char *end;
+
+    Dbc_SkipBlanks(t);
+    if (t->p == t->end || isspace((unsigned char) *t->p))
+    {
+        return false;
+    }
+    *value = strtol(t->p, &end, 10);
+    if (end == t->p)
+    {
+        return false;
+    }
+    t->p = end;
+
+    return true;
+}
+
+static bool Dbc_Unsigned(Dbc_Tokenizer_t *t, unsigned long *value)
+{
+    char *end;
+
+    Dbc_SkipBlanks(t);
+    if (t->p == t->end || !isdigit((unsigned char) *t->p))
+    {
+        return false;
+    }
+    *value = strtoul(t->p, &end, 10);
+    t->p = end;
+
+    return true;
+}
+
+static bool Dbc_Double(Dbc_Tokenizer_t *t, double *value)
+{
+    char *end;
+
+    Dbc_SkipBlanks(t);
+    if (t->p == t->end || isspace((unsigned char) *t->p))
+    {
+        return false;
+    }
+    *value = strtod(t->p, &end);
+    if (end == t->p)
+    {
+        return false;
+    }
+    t->p = end;
+
+    return true;
+}
+
+/**
+ * @brief      Reads a quoted string, which may span several lines
+ *
+ * @return     Length of the string without the quotes, -1 if there is none
+ */
+static long Dbc_Quoted(Dbc_Tokenizer_t *t, const char **start)
+{
+    const char *end;
+
+    Dbc_SkipBlanks(t);
+    if (t->p == t->end || '"' != *t->p)
+    {
+        return -1;
+    }
+    *start = t->p + 1;
+    end = memchr(*start, '"', t->end - *start);
+    if (NULL == end)
+    {
+        return -1;
+    }
+    t->p = end + 1;
+
+    return end - *start;
+}
+
+
+/* BO_ <id> <name>: <dlc> <sender> */
+static void Dbc_ParseFrame(Dbc_Builder_t *builder, Dbc_Tokenizer_t *t, canid_t *frameId)
+{
+    unsigned long id, dlc;
+    const char *name;
+    size_t nameLength;
+
+    if (!Dbc_Unsigned(t, &id) || 0 == (nameLength = Dbc_Identifier(t, &name)) ||
+        !Dbc_Accept(t, ':') || !Dbc_Unsigned(t, &dlc))
+    {
+        fprintf(stderr, "Failed to parse frame in line %u\n", t->line);
+        return;
+    }
+
+    *frameId = id;
+    Dbc_AddFrame(builder, id, dlc, name, nameLength);
+}
+
+/* SG_ <name> [M|m<id>] : <start>|<length>@<order><sign> (<factor>,<offset>) [<min>|<max>] "<unit>" <receivers> */
+static void Dbc_ParseSignal(Dbc_Builder_t *builder, Dbc_Tokenizer_t *t, canid_t frameId)
+{
+    Dbc_Signal_t signal;
+    Dbc_SignalInfo_t info;
+    long startBit, signalLength, byteOrder;
+    const char *name, *token, *end;
+    size_t nameLength, length;
+    long quotedLength;
+    char sign;
+
+    memset(&signal, 0, sizeof(signal));
+    memset(&info, 0, sizeof(info));
+
+    nameLength = Dbc_Identifier(t, &name);
+    if (0 == nameLength)
+    {
+        fprintf(stderr, "Failed to parse signal in line %u\n", t->line);
+        return;
+    }
+
+    /* Multiplexer indicator */
+    if (!Dbc_Accept(t, ':'))
+    {
+        length = Dbc_Identifier(t, &token);
+        if ('M' == token[0] && length > 0)
+        {
+            signal.isMultiplexer = DBC_MUX_DEFINE;
+        }
+        else if ('m' == token[0] && length > 1 && isdigit((unsigned char) token[1]))
+        {
+            signal.isMultiplexer = DBC_MUX_DATA;
+            signal.muxId = strtoul(token + 1, NULL, 10);
+        }
+        if (!Dbc_Accept(t, ':'))
+        {
+            fprintf(stderr, "Failed to parse signal %.*s in line %u\n", (int) nameLength, name, t->line);
+            return;
+        }
+    }
+
+    if (!Dbc_Long(t, &startBit) || !Dbc_Accept(t, '|') || !Dbc_Long(t, &signalLength) ||
+        !Dbc_Accept(t, '@') || !Dbc_Long(t, &byteOrder) || t->p == t->end ||
+        ('+' != *t->p && '-' != *t->p))
+    {
+        fprintf(stderr, "Failed to parse signal %.*s in line %u\n", (int) nameLength, name, t->line);
+        return;
+    }
+    sign = *t->p++;
+
+    if (!Dbc_Accept(t, '(') || !Dbc_Double(t, &signal.factor) || !Dbc_Accept(t, ',') ||
+        !Dbc_Double(t, &signal.offset) || !Dbc_Accept(t, ')'))
+    {
+        fprintf(stderr, "Failed to parse signal %.*s in line %u\n", (int) nameLength, name, t->line);
+        return;
+    }
+
+    /* Range, unit and receivers are optional */
+    if (Dbc_Accept(t, '[') && Dbc_Double(t, &signal.min) && Dbc_Accept(t, '|') && Dbc_Double(t, &signal.max))
+    {
+        Dbc_Accept(t, ']');
+    }
+    quotedLength = Dbc_Quoted(t, &token);
+    if (quotedLength >= 0)
+    {
+        info.unit = Dbc_Intern(builder, token, quotedLength);
+    }
+    if (!Dbc_AtLineEnd(t))
+    {
+        token = t->p;
+        end = memchr(token, '\n', t->end - token);
+        end = (NULL == end) ? t->end : end;
+        while (end > token && isspace((unsigned char) end[-1]))
+        {
+            end--;
+        }
+        info.receiverList = Dbc_Intern(builder, token, end - token);
+    }
+    info.name = Dbc_Intern(builder, name, nameLength);
+
+    signal.startBit = Dbc_ProcessStartBit(byteOrder, startBit, signalLength);  /* Check for Big Endian */
+    signal.signalLength = signalLength;
+    signal.is_big_endian = (byteOrder == DBC_BO_BIG_ENDIAN);
+    signal.is_signed = (sign == '-');
+    Dbc_AddSignal(builder, frameId, &signal, &info);
+}
+
+/* VAL_ <frame id> <signal> <value> "<string>" ... ; */
+static void Dbc_ParseValues(Dbc_Builder_t *builder, Dbc_Tokenizer_t *t)
+{
+    uint32_t frame, signal;
+    unsigned long frameId;
+    const char *token;
+    size_t length;
+    long value, quotedLength;
+
+    /* Value tables of environment variables have no frame id */
+    if (!Dbc_Unsigned(t, &frameId))
+    {
+        return;
+    }
+
+    /* Find the frame */
+    frame = Dbc_BuilderFindFrame(builder, frameId);
+    if (DBC_NONE == frame)
+    {
+        fprintf(stderr, "Failed to find a frame with id: %lu\n", frameId);
+        return;
+    }
+
+    /* Find the signal */
+    length = Dbc_Identifier(t, &token);
+    signal = Dbc_BuilderFindSignal(builder, frame, Dbc_Intern(builder, token, length));
+    if (DBC_NONE == signal)
+    {
+        fprintf(stderr, "Failed to find a signal %.*s in frame %s\n", (int) length, token,
+            builder->strings + builder->frameInfo[frame].name);
+        return;
+    }
+
+    /* Value descriptions up to the terminating ';', which may be on a later line */
+    for (;;)
+    {
+        Dbc_SkipSpaces(t);
+        if (t->p == t->end || ';' == *t->p)
+        {
+            break;
+        }
+        if (!Dbc_Long(t, &value))
+        {
+            fprintf(stderr, "Failed to parse value in line %u\n", t->line);
+            return;
+        }
+        Dbc_SkipSpaces(t);
+        quotedLength = Dbc_Quoted(t, &token);
+        if (quotedLength < 0)
+        {
+            fprintf(stderr, "Failed to find a string token\n");
+            return;
+        }
+
+        Dbc_AddValue(builder, signal, value, token, quotedLength);
+    }
+}
+
+/* Orders values by signal and value, equal values in definition order */
+static int Dbc_CompareValues(const void *a, const void *b)
+{
+    const Dbc_ValueInfo_t *valueA = a, *valueB = b;
+
+    if (valueA->signal != valueB->signal)
+    {
+        return (valueA->signal > valueB->signal) - (valueA->signal < valueB->signal);
+    }
+    if (valueA->value != valueB->value)
+    {
+        return (valueA->value > valueB->value) - (valueA->value < valueB->value);
+    }
+
+    return (valueA->sequence > valueB->sequence) - (valueA->sequence < valueB->sequence);
+}
+
+/* Size of a name index for count names, at most half full */
+static uint32_t Dbc_NameIndexSize(uint32_t count)
+{
+    uint32_t size = 1;
+
+    if (0 == count)
+    {
+        return 0;
+    }
+    while (size < 2 * count)
+    {
+        size *= 2;
+    }
+
+    return size;
+}
+
+static uint32_t Dbc_CountSignals(const Dbc_Builder_t *builder, uint32_t frame)
+{
+    uint32_t s, count = 0;
+
+    for (s = builder->frameInfo[frame].firstSignal; DBC_NONE != s; s = builder->signalInfo[s].nextSignal)
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief      Adds an object to a name index, keeping the first object of a name
+ *
+ * Names are interned, so equal names have equal pointers.
+ *
+ * @param      index       The index, with room for the object
+ * @param[in]  mask        The index size - 1
+ * @param[in]  names       The name field of the first object of the array
+ * @param[in]  stride      Size of the objects
+ * @param[in]  object      Index of the object in the array
+ */
+static void Dbc_IndexName(uint32_t *index, uint32_t mask, const char * const *names, size_t stride, uint32_t object)
+{
+    const char *name = *(const char * const *) ((const char *) names + object * stride);
+    uint32_t slot;
+
+    for (slot = Dbc_HashString(name, strlen(name)) & mask; 0 != index[slot]; slot = (slot + 1) & mask)
+    {
+        if (*(const char * const *) ((const char *) names + (index[slot] - 1) * stride) == name)
+        {
+            return;
+        }
+    }
+    index[slot] = object + 1;
+}
+
+/* Reserves room for count elements in the database block */
+static size_t Dbc_Place(size_t *size, size_t count, size_t elementSize)
+{
+    size_t offset = DBC_ALIGN(*size);
+
+    *size = offset + count * elementSize;
+    return offset;
+}
+
+/**
+ * @brief      Copies a parsed database into a single block and compiles it
+ *
+ * @param      builder  The parsed database
+ *
+ * @return     The database or NULL if out of memory
+ */
+static Dbc_Database_t *Dbc_Finalize(Dbc_Builder_t *builder)
+{
+    Dbc_Database_t *db;
+    Dbc_Frame_t *frame;
+    Dbc_Signal_t *signals, *signal;
+    Dbc_Value_t *values;
+    Dbc_DecodeStep_t *steps;
+    Dbc_MuxPage_t *pages;
+    const char **tables;
+    char *strings, *block;
+    uint32_t *signalMap, *signalIndex;
+    uint32_t i, j, s, valueCount = 0, pageCount = 0, tableLength = 0, indexSize = 1, signalIndexSize = 0, maxMuxId;
+    size_t size = sizeof(Dbc_Database_t), framesOffset, indexOffset, nameIndexOffset, signalsOffset,
+        signalIndexOffset, stepsOffset, pagesOffset, valuesOffset, tablesOffset, stringsOffset;
+    bool hasMultiplexer;
+
+    /* Values grouped by signal and sorted, keeping the last definition of a value */
+    if (builder->valueCount > 0)
+    {
+        qsort(builder->values, builder->valueCount, sizeof(Dbc_ValueInfo_t), Dbc_CompareValues);
+    }
+    for (i = 0; i < builder->valueCount; i++)
+    {
+        if (i + 1 < builder->valueCount && builder->values[i + 1].signal == builder->values[i].signal &&
+            builder->values[i + 1].value == builder->values[i].value)
+        {
+            continue;
+        }
+        builder->values[valueCount++] = builder->values[i];
+    }
+    builder->valueCount = valueCount;
+
+    /* Sizes of the value tables and multiplexer pages */
+    for (i = 0; i < builder->valueCount; i = j)
+    {
+        j = i + 1;
+        while (j < builder->valueCount && builder->values[j].signal == builder->values[i].signal)
+        {
+            j++;
+        }
+        tableLength += Dbc_DenseTableLength(builder->values[i].value, builder->values[j - 1].value, j - i);
+    }
+    for (i = 0; i < builder->frameCount; i++)
+    {
+        hasMultiplexer = false;
+        maxMuxId = 0;
+        for (s = builder->frameInfo[i].firstSignal; DBC_NONE != s; s = builder->signalInfo[s].nextSignal)
+        {
+            hasMultiplexer |= (DBC_MUX_DEFINE == builder->signals[s].isMultiplexer);
+            if (DBC_MUX_DATA == builder->signals[s].isMultiplexer && builder->signals[s].muxId > maxMuxId)
+            {
+                maxMuxId = builder->signals[s].muxId;
+            }
+        }
+        builder->frames[i].muxPageCount = hasMultiplexer ? maxMuxId + 1 : 0;
+        pageCount += builder->frames[i].muxPageCount;
+        signalIndexSize += Dbc_NameIndexSize(Dbc_CountSignals(builder, i));
+    }
+    while (indexSize < 2 * builder->frameCount)
+    {
+        indexSize *= 2;
+    }
+
+    framesOffset = Dbc_Place(&size, builder->frameCount, sizeof(Dbc_Frame_t));
+    indexOffset = Dbc_Place(&size, indexSize, sizeof(uint32_t));
+    nameIndexOffset = Dbc_Place(&size, indexSize, sizeof(uint32_t));
+    signalsOffset = Dbc_Place(&size, builder->signalCount, sizeof(Dbc_Signal_t));
+    signalIndexOffset = Dbc_Place(&size, signalIndexSize, sizeof(uint32_t));
+    stepsOffset = Dbc_Place(&size, builder->signalCount, sizeof(Dbc_DecodeStep_t));
+    pagesOffset = Dbc_Place(&size, pageCount, sizeof(Dbc_MuxPage_t));
+    valuesOffset = Dbc_Place(&size, builder->valueCount, sizeof(Dbc_Value_t));
+    tablesOffset = Dbc_Place(&size, tableLength, sizeof(const char *));
+    stringsOffset = Dbc_Place(&size, builder->stringsSize, 1);
+    size = DBC_ALIGN(size);
+
+    block = calloc(1, size);
+    signalMap = malloc((builder->signalCount + 1) * sizeof(uint32_t));
+    if (NULL == block || NULL == signalMap)
+    {
+        free(block);
+        free(signalMap);
+        return NULL;
+    }
+
+    db = (Dbc_Database_t *) block;
+    db->frames = (Dbc_Frame_t *) (block + framesOffset);
+    db->frameCount = builder->frameCount;
+    db->frameIndex = (uint32_t *) (block + indexOffset);
+    db->frameIndexMask = indexSize - 1;
+    db->frameNameIndex = (uint32_t *) (block + nameIndexOffset);
+    db->size = size;
+    signals = (Dbc_Signal_t *) (block + signalsOffset);
+    signalIndex = (uint32_t *) (block + signalIndexOffset);
+    steps = (Dbc_DecodeStep_t *) (block + stepsOffset);
+    pages = (Dbc_MuxPage_t *) (block + pagesOffset);
+    values = (Dbc_Value_t *) (block + valuesOffset);
+    tables = (const char **) (block + tablesOffset);
+    strings = block + stringsOffset;
+    memcpy(strings, builder->strings, builder->stringsSize);
+
+    /* Frames with their signals in DBC order */
+    signal = signals;
+    for (i = 0; i < builder->frameCount; i++)
+    {
+        frame = &db->frames[i];
+        *frame = builder->frames[i];
+        frame->name = strings + builder->frameInfo[i].name;
+        frame->signals = signal;
+        for (s = builder->frameInfo[i].firstSignal; DBC_NONE != s; s = builder->signalInfo[s].nextSignal)
+        {
+            *signal = builder->signals[s];
+            signal->name = strings + builder->signalInfo[s].name;
+            signal->unit = strings + builder->signalInfo[s].unit;
+            signal->receiverList = strings + builder->signalInfo[s].receiverList;
+            signalMap[s] = signal - signals;
+            signal++;
+        }
+        frame->signalCount = signal - frame->signals;
+        Dbc_IndexFrame(db->frames, db->frameIndex, db->frameIndexMask, i);
+        Dbc_IndexName(db->frameNameIndex, db->frameIndexMask, &db->frames[0].name, sizeof(Dbc_Frame_t), i);
+
+        if (frame->signalCount > 0)
+        {
+            frame->signalIndex = signalIndex;
+            frame->signalIndexMask = Dbc_NameIndexSize(frame->signalCount) - 1;
+            for (j = 0; j < frame->signalCount; j++)
+            {
+                Dbc_IndexName(frame->signalIndex, frame->signalIndexMask, &frame->signals[0].name, sizeof(Dbc_Signal_t), j);
+            }
+            signalIndex += frame->signalIndexMask + 1;
+        }
+    }
+
+    /* Values of each signal are adjacent */
+    for (i = 0; i < builder->valueCount; i++)
+    {
+        signal = &signals[signalMap[builder->values[i].signal]];
+        if (NULL == signal->values)
+        {
+            signal->values = &values[i];
+        }
+        values[i].name = strings + builder->values[i].name;
+        values[i].value = builder->values[i].value;
+        signal->valueCount++;
+    }
+    free(signalMap);
+
+    for (signal = signals; signal < signals + builder->signalCount; signal++)
+    {
+        Dbc_CompileValueTable(signal, tables);
+        tables += signal->valueTableLength;
+    }
+    for (frame = db->frames; frame < db->frames + db->frameCount; frame++)
+    {
+        pageCount = frame->muxPageCount;
+        Dbc_CompilePlan(frame, steps, pages);
+        steps += frame->signalCount;
+        pages += pageCount;
+    }
+
+    return db;
+}
+
+char *Dbc_ReadFile(char *dbcFilePath, size_t *size)
+{
+    char *contents, *grown;
+    size_t length = 0, capacity;
+    struct stat st;
+
+    FILE *fp = fopen(dbcFilePath, "r");
+    if(NULL == fp)
+    {
+        fprintf(stderr, "Error opening %s\n", dbcFilePath);
+        return NULL;
+    }
+
+    /* The size is only a hint, pipes have none; a spare byte lets the read of a file end short */
+    capacity = (0 == fstat(fileno(fp), &st) && S_ISREG(st.st_mode) && st.st_size > 0) ? (size_t) st.st_size + 2 : DBC_READ_SIZE;
+
+    /* Read the whole file, NUL terminated for strtod() and friends */
+    contents = malloc(capacity);
+    while (NULL != contents)
+    {
+        length += fread(contents + length, 1, capacity - 1 - length, fp);
+        if (length + 1 < capacity || ferror(fp))
+        {
+            break;
+        }
+        capacity *= 2;
+        grown = realloc(contents, capacity);
+        if (NULL == grown)
+        {
+            free(contents);
+        }
+        contents = grown;
+    }
+    if (NULL == contents || ferror(fp))
+    {
+        fprintf(stderr, "Error reading %s\n", dbcFilePath);
+        free(contents);
+        fclose(fp);
+        return NULL;
+    }
+    contents[length] = '\0';
+    fclose(fp);
+
+    *size = length;
+    return contents;
+}
+
+int32_t Dbc_Parse(Dbc_Database_t **db, const char *contents, size_t size)
+{
+    Dbc_Builder_t builder;
+    Dbc_Tokenizer_t t;
+    const char *keyword, *statement;
+    size_t keywordLength;
+    canid_t frameId = 0;
+
+    /* The empty string is at offset 0, the default of missing units and receivers */
+    memset(&builder, 0, sizeof(builder));
+    Dbc_Intern(&builder, "", 0);
+
+    /* One pass over the file, dispatching on the keyword of every statement */
+    t.p = contents;
+    t.end = contents + size;
+    t.line = 1;
+    while (t.p < t.end && !builder.failed)
+    {
+        statement = t.p;
+        keywordLength = Dbc_Identifier(&t, &keyword);
+
+        /* The keyword alone (e.g. in the NS_ list) is no statement */
+        if (keywordLength > 0 && !Dbc_AtLineEnd(&t))
+        {
+            if (3 == keywordLength && 0 == memcmp(keyword, "BO_", 3))
+            {
+                Dbc_ParseFrame(&builder, &t, &frameId);
+            }
+            else if (3 == keywordLength && 0 == memcmp(keyword, "SG_", 3))
+            {
+                Dbc_ParseSignal(&builder, &t, frameId);
+            }
+            else if (4 == keywordLength && 0 == memcmp(keyword, "VAL_", 4))
+            {
+                Dbc_ParseValues(&builder, &t);
+            }
+        }
+
+        Dbc_SkipLine(&t);
+        for (; statement < t.p; statement++)
+        {
+            t.line += ('\n' == *statement);
+        }
+    }
+
+    *db = builder.failed ? NULL : Dbc_Finalize(&builder);
+    Dbc_FreeBuilder(&builder);
+    if (NULL == *db)
+    {
+        fprintf(stderr, "Out of memory while reading the database\n");
+        return -1;
+    }
+
+    return 0;
+}
+
+int32_t Dbc_Init(Dbc_Database_t **db, char *dbcFilePath)
+{
+    char *contents;
+    size_t size;
+    int32_t ret;
+
+    contents = Dbc_ReadFile(dbcFilePath, &size);
+    if (NULL == contents)
+    {
+        return -1;
+    }
+    ret = Dbc_Parse(db, contents, size);
+    free(contents);
+
+    return ret;
+}
+
+void Dbc_DeInit(Dbc_Database_t *db)
+{
+    if (NULL == db)
+    {
+        return;
+    }
+
+    /* Everything is part of one block, or of one mapping if loaded from a cache */
+    if (db->isCached)
+    {
+        DbcCache_Unmap(db);
+    }
+    else
+    {
+        free(db);
     }
 }
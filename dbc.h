@@ -11,8 +11,10 @@
 Section: Included Files
 */
 
-#include "uthash.h"
-
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include <net/if.h>
 #include <linux/can.h>
 #include "lib.h"
@@ -21,15 +23,16 @@ Section: Included Files
 Section: Definitions
 */
 
-#define DBC_MAX_LINE_SIZE     4096
-#define DBC_MAX_FRAME_NAME    80
-#define DBC_MAX_SENDER_NAME   128
-#define DBC_MAX_SIGNAL_NAME   80
-#define DBC_MAX_VALUE_NAME    80
-#define DBC_MAX_UNIT_NAME     80
-#define DBC_MAX_RECEIVER_LIST 256
-#define DBC_MAX_MUXLEN        4
-#define DBC_MIN_SIGNAL_SCAN   5
+#define DBC_MAX_DENSE_VALUES  256  /**< Value tables up to this range are always dense */
+#define DBC_DENSE_VALUE_RATIO 4    /**< Larger tables are dense if range <= ratio * entries */
+
+/* Dbc_DecodeStep_t flags */
+#define DBC_STEP_BIG_ENDIAN   0x01
+#define DBC_STEP_SIGNED       0x02
+#define DBC_STEP_VALUES       0x04  /**< Signal has a VAL_ table */
+#define DBC_STEP_MULTIPLEXED  0x08  /**< Decoded only for its muxId (DBC_MUX_DATA) */
+#define DBC_STEP_SCALE_SHIFT  4     /**< Dbc_Scale_t in bits 4 and 5 */
+#define DBC_STEP_SCALE(flags) ((Dbc_Scale_t) (((flags) >> DBC_STEP_SCALE_SHIFT) & 0x03))
 
 /**
 Section: Public Types
@@ -48,46 +51,121 @@ typedef enum
 	DBC_MUX_DATA = 2
 } Dbc_Mux_t;
 
+/**
+ * Scaling classes of a signal, selected at load time
+ */
+typedef enum
+{
+	DBC_SCALE_IDENTITY = 0,  /**< factor 1, offset 0: physical value == raw value */
+	DBC_SCALE_INTEGER = 1,   /**< integral factor and offset, computed exactly in 64 bit integers */
+	DBC_SCALE_GENERAL = 2    /**< raw * factor + offset in double precision */
+} Dbc_Scale_t;
+
+/**
+ * One VAL_ description. The values of a signal are sorted by value.
+ */
 typedef struct
 {
-	char name[DBC_MAX_VALUE_NAME];
+	const char *name;
 	int32_t value;
-
-	UT_hash_handle hh;
 } Dbc_Value_t;
 
 typedef struct
 {
-	char name[DBC_MAX_SIGNAL_NAME];
+	const char *name;
 	int startBit;
 	int signalLength;
 	int is_big_endian;  /**< Intel = 0; Motorola (== BIG Endian) = 1 */
 	int is_signed;
-	float factor;
-	float offset;
-	float min;
-	float max;
-	char unit[DBC_MAX_UNIT_NAME];
-	char receiverList[DBC_MAX_RECEIVER_LIST];
-    uint8_t isMultiplexer;
-    uint8_t muxId;
-	uint8_t number;
-	Dbc_Value_t *values;
-
-	UT_hash_handle hh;
+	double factor;
+	double offset;
+	double min;
+	double max;
+	const char *unit;
+	const char *receiverList;
+	uint8_t isMultiplexer;
+	uint16_t muxId;
+	Dbc_Value_t *values;      /**< VAL_ descriptions, sorted by value */
+	uint32_t valueCount;
+	const char **valueTable;  /**< Dense value strings indexed by (value - valueMin); NULL if sparse */
+	int32_t valueMin;
+	uint32_t valueTableLength;
 } Dbc_Signal_t;
 
+/**
+ * One precompiled signal decode step, built by Dbc_Init from a Dbc_Signal_t.
+ * Steps hold everything the decode loop needs and are packed per frame; the
+ * names, unit, range and value tables stay in the Dbc_Signal_t.
+ *
+ * The 8 payload bytes starting at byteOffset are read as one 64 bit word
+ * (little endian for Intel, big endian for Motorola signals), shifted right
+ * by shift, masked to length bits and sign extended for signed signals.
+ * Classic frames always use byteOffset 0, CAN FD frames use the window
+ * holding the signal.
+ */
 typedef struct
 {
-	canid_t canID;
-	uint8_t dlc;
-	char name[DBC_MAX_FRAME_NAME];
-    uint8_t isMultiplexed;
-	Dbc_Signal_t *signals;
+	double factor;
+	double offset;
+	uint8_t byteOffset;  /**< First payload byte of the window */
+	uint8_t shift;  /**< Position of the LSB in the payload word */
+	uint8_t length;  /**< Signal length in bits; 0 for unused steps */
+	uint8_t flags;  /**< DBC_STEP_* and the Dbc_Scale_t */
+	uint16_t muxId;
+	uint16_t signal;  /**< Index of the signal in the signals of the frame */
+} Dbc_DecodeStep_t;
+
+/**
+ * Range of decode steps that are active for one multiplexer value
+ */
+typedef struct
+{
+	unsigned int first;
+	unsigned int count;
+} Dbc_MuxPage_t;
 
-	UT_hash_handle hh;
+typedef struct
+{
+	canid_t canID;
+	uint8_t dlc;  /**< Payload length in bytes, up to CANFD_MAX_DLEN */
+	const char *name;
+	uint8_t isMultiplexed;
+	uint32_t signalIndexMask;
+	Dbc_Signal_t *signals;  /**< In DBC order */
+	unsigned int signalCount;
+	uint32_t *signalIndex;  /**< Open addressing hash of the signal names: signal index + 1, 0 if free; NULL without signals */
+	/**
+	 * Decode steps. The multiplexer (if any) comes first, followed by the not
+	 * multiplexed signals and then the multiplexed signals grouped by muxId.
+	 * Within each group the DBC signal order is kept.
+	 */
+	Dbc_DecodeStep_t *plan;
+	unsigned int planLength;
+	unsigned int staticLength;   /**< Steps decoded regardless of the multiplexer value */
+	Dbc_DecodeStep_t *muxStep;   /**< Multiplexer step; NULL if not multiplexed */
+	Dbc_MuxPage_t *muxPages;     /**< Multiplexed steps, indexed by multiplexer value */
+	unsigned int muxPageCount;
 } Dbc_Frame_t;
 
+/**
+ * A database is a single block of memory: this structure, followed by the
+ * frames, the frame indexes, the signals with their name indexes, the decode
+ * plans, the value tables and the interned strings of all names. All pointers
+ * point into the block.
+ */
+typedef struct
+{
+	Dbc_Frame_t *frames;  /**< In DBC order */
+	unsigned int frameCount;
+	uint32_t *frameIndex;  /**< Open addressing hash of the normalized CAN IDs: frame index + 1, 0 if free */
+	uint32_t frameIndexMask;
+	uint32_t *frameNameIndex;  /**< Like frameIndex, but hashes the frame names; same size */
+	size_t size;  /**< Size of the block */
+	uint8_t isCached;  /**< Mapped by DbcCache_Init() instead of allocated */
+} Dbc_Database_t;
+
+typedef void (*Dbc_SelectHandler_t)(Dbc_Frame_t *frame, Dbc_Signal_t *signal, void *context);
+
 /**
 Section: Public Function Declarations
 */
@@ -100,31 +178,170 @@ Section: Public Function Declarations
  *
  * @return     0 on success and a negative value otherwise
  */
-int32_t Dbc_Init(Dbc_Frame_t **db, char *dbcFilePath);
+int32_t Dbc_Init(Dbc_Database_t **db, char *dbcFilePath);
+
+/**
+ * @brief      Reads a whole .dbc file into memory
+ *
+ * @param      dbcFilePath[in]  The dbc file path
+ * @param      size[out]        Size of the file contents
+ *
+ * @return     The NUL terminated contents (to be freed by the caller) or NULL on error
+ */
+char *Dbc_ReadFile(char *dbcFilePath, size_t *size);
+
+/**
+ * @brief      Extracts all info of the DBC file contents in db parameter
+ *
+ * @param      db[out]        The database
+ * @param      contents[in]   The NUL terminated file contents
+ * @param      size[in]       Size of the contents without the NUL
+ *
+ * @return     0 on success and a negative value otherwise
+ */
+int32_t Dbc_Parse(Dbc_Database_t **db, const char *contents, size_t size);
 
 /**
  * @brief      Free all memory taken by frame and signal descriptions
  *
+ * @param[in]  db    The database, may be NULL
+ */
+void Dbc_DeInit(Dbc_Database_t *db);
+
+/**
+ * @brief      Maps a CAN ID to the key used by the frame hash
+ *
+ * Extended IDs from the DBC (bit 31 set in BO_) and CAN_EFF_FLAG IDs from
+ * SocketCAN share the same flag bit. RTR and error flags are dropped, so a
+ * received ID and a DBC ID of the same frame always produce the same key.
+ * Received remote and error frames have to be rejected with
+ * Dbc_IsDataFrame() first, they carry no signals.
+ *
+ * @param[in]  canID  The DBC or SocketCAN frame ID
+ *
+ * @return     The normalized ID
+ */
+static inline canid_t Dbc_NormalizeId(canid_t canID)
+{
+	if (canID & CAN_EFF_FLAG)
+	{
+		return (canID & CAN_EFF_MASK) | CAN_EFF_FLAG;
+	}
+
+	return canID & CAN_EFF_MASK;
+}
+
+/**
+ * @brief      Checks whether a received CAN ID belongs to a data frame
+ *
+ * @param[in]  canID  The SocketCAN frame ID
+ *
+ * @return     false for remote (CAN_RTR_FLAG) and error (CAN_ERR_FLAG) frames
+ */
+static inline bool Dbc_IsDataFrame(canid_t canID)
+{
+	return !(canID & (CAN_RTR_FLAG | CAN_ERR_FLAG));
+}
+
+/**
+ * @brief      Finds a frame by its (not necessarily normalized) CAN ID
+ *
+ * @param[in]  db     The database
+ * @param[in]  canID  The DBC or SocketCAN frame ID
+ *
+ * @return     The frame or NULL if the ID is not part of the database
+ */
+Dbc_Frame_t *Dbc_FindFrame(const Dbc_Database_t *db, canid_t canID);
+
+/**
+ * @brief      Finds a frame by its name using the frame name index
+ *
  * @param[in]  db    The database
+ * @param[in]  name  The frame name
+ *
+ * @return     The first frame with that name or NULL
  */
-void Dbc_DeInit(Dbc_Frame_t *db);
+Dbc_Frame_t *Dbc_FindFrameByName(const Dbc_Database_t *db, const char *name);
 
-Dbc_Frame_t *Dbc_FindFrame(Dbc_Frame_t *frame_list, canid_t canID);
-Dbc_Frame_t *Dbc_FindFrameByName(Dbc_Frame_t *frame_list, char *name);
-Dbc_Frame_t *Dbc_FindFrameBySignalname(Dbc_Frame_t *frame_list, char *name);
+/**
+ * @brief      Finds the first frame with a signal of the given name
+ *
+ * @param[in]  db    The database
+ * @param[in]  name  The signal name
+ *
+ * @return     The frame or NULL
+ */
+Dbc_Frame_t *Dbc_FindFrameBySignalname(const Dbc_Database_t *db, const char *name);
 
-Dbc_Signal_t *Dbc_FindSignalByName(Dbc_Frame_t *frame, char *name);
+/**
+ * @brief      Finds a signal of a frame by its name using the signal name index
+ *
+ * @param[in]  frame  The frame
+ * @param[in]  name   The signal name
+ *
+ * @return     The first signal with that name or NULL
+ */
+Dbc_Signal_t *Dbc_FindSignalByName(const Dbc_Frame_t *frame, const char *name);
 
-const char *Dbc_FindValueString(Dbc_Signal_t *signal, int32_t value);
+/**
+ * @brief      Tells whether a frame or signal selector is a glob pattern
+ *
+ * @param[in]  selector  The selector
+ *
+ * @return     true if it contains *, ?, [ or \
+ */
+bool Dbc_IsPattern(const char *selector);
+
+/**
+ * @brief      Resolves a frame and signal selector to the matching signals
+ *
+ * Selectors are either exact names, which are looked up in the name indexes,
+ * or fnmatch() glob patterns, which are matched against all frames or all
+ * signals of the matching frames. handler is called once per match, in DBC
+ * order.
+ *
+ * @param[in]  db              The database
+ * @param[in]  frameSelector   The frame name or pattern
+ * @param[in]  signalSelector  The signal name or pattern; NULL selects whole frames
+ * @param[in]  handler         Called with the frame and the signal (NULL for whole frames)
+ * @param      context         Passed to handler
+ *
+ * @return     The number of matches
+ */
+unsigned int Dbc_Select(const Dbc_Database_t *db, const char *frameSelector, const char *signalSelector,
+	Dbc_SelectHandler_t handler, void *context);
+
+/**
+ * @brief      Finds the precompiled decode step of a signal
+ *
+ * @param[in]  frame   The frame the signal belongs to
+ * @param[in]  signal  The signal
+ *
+ * @return     The decode step or NULL if the signal can't be decoded
+ */
+Dbc_DecodeStep_t *Dbc_FindDecodeStep(Dbc_Frame_t *frame, Dbc_Signal_t *signal);
+
+/**
+ * @brief      Returns the signal description of a decode step
+ *
+ * @param[in]  frame  The frame the step belongs to
+ * @param[in]  step   The decode step
+ *
+ * @return     The signal
+ */
+static inline Dbc_Signal_t *Dbc_StepSignal(const Dbc_Frame_t *frame, const Dbc_DecodeStep_t *step)
+{
+	return &frame->signals[step->signal];
+}
 
-void Dbc_AddFrame(Dbc_Frame_t **db, canid_t canID, uint8_t dlc, char *frameName);
-void Dbc_AddSignal(
-    Dbc_Frame_t *frame_list, int32_t frameId,
-    char *signalName, int startBit, int signalLength,
-    int is_big_endian, int signedState,
-    float factor, float offset, float min, float max,
-    char *unit,
-    char *receiverList,
-    unsigned char isMultiplexer, unsigned char muxId);
+/**
+ * @brief      Finds the VAL_ string of a raw signal value
+ *
+ * @param[in]  signal  The signal
+ * @param[in]  value   The raw value
+ *
+ * @return     The value string or NULL if there is none
+ */
+const char *Dbc_FindValueString(const Dbc_Signal_t *signal, int32_t value);
 
 #endif  /* DBC_H */
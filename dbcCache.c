@@ -0,0 +1,547 @@
+/**
+ * @file dbcCache.c
+ *
+ * Binary cache of a parsed DBC database
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "dbcCache.h"
+
+/**
+Section: Private Types
+*/
+
+/**
+ * The image is a copy of the database block behind the header. Every pointer
+ * field of the copy is replaced by the address of its target in an image
+ * mapped at DBC_CACHE_BASE.
+ */
+typedef struct
+{
+	const char *block;  /**< The database block */
+	char *image;
+	size_t imageSize;
+	bool failed;
+} DbcCache_Writer_t;
+
+/**
+ * A mapped image. Its pointers are used as they are if it was mapped at the
+ * address it was linked against and relocated otherwise.
+ */
+typedef struct
+{
+	char *image;
+	uint64_t imageSize;
+	uint64_t database;  /**< Offset of the database block */
+	uintptr_t base;  /**< Address the image was linked against */
+	bool relocate;
+} DbcCache_Reader_t;
+
+/**
+Section: Private functions
+*/
+
+/**
+ * @brief      Links a pointer field of the database against DBC_CACHE_BASE
+ *
+ * @param      writer  The writer
+ * @param[in]  field   Address of the pointer field in the database block
+ */
+static void DbcCache_Pointer(DbcCache_Writer_t *writer, const void *field)
+{
+	const uint64_t base = DBC_CACHE_ALIGN(sizeof(DbcCache_Header_t));
+	const char *target;
+	uint64_t location, offset;
+	uintptr_t address;
+
+	memcpy(&target, field, sizeof(target));
+	if (NULL == target || writer->failed)
+	{
+		return;
+	}
+
+	location = base + ((const char *) field - writer->block);
+	offset = base + (target - writer->block);
+	if (target < writer->block || offset >= writer->imageSize)
+	{
+		writer->failed = true;
+		return;
+	}
+
+	address = DBC_CACHE_BASE + offset;
+	memcpy(writer->image + location, &address, sizeof(address));
+}
+
+/* Visits all pointer fields of the database */
+static void DbcCache_LinkDatabase(DbcCache_Writer_t *writer, const Dbc_Database_t *db)
+{
+	const Dbc_Frame_t *frame;
+	const Dbc_Signal_t *signal;
+	uint32_t i;
+
+	DbcCache_Pointer(writer, &db->frames);
+	DbcCache_Pointer(writer, &db->frameIndex);
+	DbcCache_Pointer(writer, &db->frameNameIndex);
+	for (frame = db->frames; frame < db->frames + db->frameCount; frame++)
+	{
+		DbcCache_Pointer(writer, &frame->name);
+		DbcCache_Pointer(writer, &frame->signals);
+		DbcCache_Pointer(writer, &frame->signalIndex);
+		DbcCache_Pointer(writer, &frame->plan);
+		DbcCache_Pointer(writer, &frame->muxStep);
+		DbcCache_Pointer(writer, &frame->muxPages);
+
+		for (signal = frame->signals; signal < frame->signals + frame->signalCount; signal++)
+		{
+			DbcCache_Pointer(writer, &signal->name);
+			DbcCache_Pointer(writer, &signal->unit);
+			DbcCache_Pointer(writer, &signal->receiverList);
+			DbcCache_Pointer(writer, &signal->values);
+			DbcCache_Pointer(writer, &signal->valueTable);
+			for (i = 0; i < signal->valueCount; i++)
+			{
+				DbcCache_Pointer(writer, &signal->values[i].name);
+			}
+			for (i = 0; NULL != signal->valueTable && i < signal->valueTableLength; i++)
+			{
+				DbcCache_Pointer(writer, &signal->valueTable[i]);
+			}
+		}
+	}
+}
+
+/**
+ * @brief      Checks a pointer field of a mapped image and relocates it if needed
+ *
+ * A pointer has to point to count objects that lie inside the database block.
+ * NULL is only accepted for no objects.
+ *
+ * @param[in]  reader      The reader
+ * @param      field       Address of the pointer field in the image
+ * @param[in]  count       Number of objects the pointer refers to
+ * @param[in]  objectSize  Size of one object
+ * @param[in]  alignment   Alignment of the objects
+ *
+ * @return     true if the pointer is valid
+ */
+static bool DbcCache_Field(const DbcCache_Reader_t *reader, void *field, uint64_t count, size_t objectSize, size_t alignment)
+{
+	uintptr_t address;
+	uint64_t offset;
+
+	memcpy(&address, field, sizeof(address));
+	if (0 == address)
+	{
+		return 0 == count;
+	}
+
+	offset = (uint64_t) (address - reader->base);
+	if (address < reader->base || offset < reader->database || offset > reader->imageSize ||
+		count > (reader->imageSize - offset) / objectSize || offset % alignment)
+	{
+		return false;
+	}
+
+	if (reader->relocate)
+	{
+		address = (uintptr_t) reader->image + offset;
+		memcpy(field, &address, sizeof(address));
+	}
+
+	return true;
+}
+
+/* Strings are NUL terminated by the last byte of the image at the latest */
+static bool DbcCache_String(const DbcCache_Reader_t *reader, const char **field)
+{
+	return DbcCache_Field(reader, field, 1, 1, 1);
+}
+
+/* An open addressing hash of count objects: entries are an object index + 1, at least one slot is free */
+static bool DbcCache_Index(const uint32_t *index, uint32_t mask, uint32_t count)
+{
+	uint64_t i, used = 0;
+
+	if (mask & (mask + 1ULL) || count > mask)
+	{
+		return false;
+	}
+	for (i = 0; i <= mask; i++)
+	{
+		if (index[i] > count)
+		{
+			return false;
+		}
+		used += (0 != index[i]);
+	}
+
+	return used <= count;
+}
+
+static bool DbcCache_CheckSignal(const DbcCache_Reader_t *reader, Dbc_Signal_t *signal)
+{
+	uint32_t i;
+
+	if (!DbcCache_String(reader, &signal->name) ||
+		!DbcCache_String(reader, &signal->unit) ||
+		!DbcCache_String(reader, &signal->receiverList) ||
+		!DbcCache_Field(reader, &signal->values, signal->valueCount, sizeof(Dbc_Value_t), _Alignof(Dbc_Value_t)) ||
+		!DbcCache_Field(reader, &signal->valueTable, signal->valueTableLength, sizeof(const char *), _Alignof(const char *)))
+	{
+		return false;
+	}
+	for (i = 0; i < signal->valueCount; i++)
+	{
+		if (!DbcCache_String(reader, &signal->values[i].name))
+		{
+			return false;
+		}
+	}
+	for (i = 0; i < signal->valueTableLength; i++)
+	{
+		/* Values missing from a dense table are NULL */
+		if (NULL != signal->valueTable[i] && !DbcCache_String(reader, &signal->valueTable[i]))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool DbcCache_CheckFrame(const DbcCache_Reader_t *reader, Dbc_Frame_t *frame)
+{
+	const Dbc_DecodeStep_t *step;
+	const Dbc_MuxPage_t *page;
+	Dbc_Signal_t *signal;
+	uint64_t muxStep;
+
+	if (!DbcCache_String(reader, &frame->name) ||
+		!DbcCache_Field(reader, &frame->signals, frame->signalCount, sizeof(Dbc_Signal_t), _Alignof(Dbc_Signal_t)) ||
+		!DbcCache_Field(reader, &frame->signalIndex, frame->signalCount ? frame->signalIndexMask + 1ULL : 0,
+			sizeof(uint32_t), _Alignof(uint32_t)) ||
+		(0 == frame->signalCount && NULL != frame->signalIndex) ||
+		(NULL != frame->signalIndex && !DbcCache_Index(frame->signalIndex, frame->signalIndexMask, frame->signalCount)) ||
+		!DbcCache_Field(reader, &frame->plan, frame->planLength, sizeof(Dbc_DecodeStep_t), _Alignof(Dbc_DecodeStep_t)) ||
+		!DbcCache_Field(reader, &frame->muxStep, NULL != frame->muxStep, sizeof(Dbc_DecodeStep_t), _Alignof(Dbc_DecodeStep_t)) ||
+		!DbcCache_Field(reader, &frame->muxPages, frame->muxPageCount, sizeof(Dbc_MuxPage_t), _Alignof(Dbc_MuxPage_t)) ||
+		frame->dlc > CANFD_MAX_DLEN || frame->staticLength > frame->planLength)
+	{
+		return false;
+	}
+
+	/* The multiplexer is one of the static steps */
+	if (NULL != frame->muxStep)
+	{
+		muxStep = (uint64_t) ((const char *) frame->muxStep - (const char *) frame->plan);
+		if (frame->muxStep < frame->plan || muxStep % sizeof(Dbc_DecodeStep_t) ||
+			muxStep / sizeof(Dbc_DecodeStep_t) >= frame->staticLength)
+		{
+			return false;
+		}
+	}
+
+	for (step = frame->plan; step < frame->plan + frame->planLength; step++)
+	{
+		if (step->signal >= frame->signalCount || step->length > 64 || step->shift >= 64 ||
+			step->byteOffset > CANFD_MAX_DLEN - sizeof(__u64) ||
+			(step - frame->plan >= frame->staticLength && step->muxId >= frame->muxPageCount))
+		{
+			return false;
+		}
+	}
+	for (page = frame->muxPages; page < frame->muxPages + frame->muxPageCount; page++)
+	{
+		if (page->first < frame->staticLength || page->first > frame->planLength ||
+			page->count > frame->planLength - page->first)
+		{
+			return false;
+		}
+	}
+
+	for (signal = frame->signals; signal < frame->signals + frame->signalCount; signal++)
+	{
+		if (!DbcCache_CheckSignal(reader, signal))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* Checks every pointer, count and index of the database before it is used */
+static bool DbcCache_CheckDatabase(const DbcCache_Reader_t *reader, Dbc_Database_t *db)
+{
+	Dbc_Frame_t *frame;
+
+	if (1 != db->isCached ||
+		!DbcCache_Field(reader, &db->frames, db->frameCount, sizeof(Dbc_Frame_t), _Alignof(Dbc_Frame_t)) ||
+		!DbcCache_Field(reader, &db->frameIndex, db->frameIndexMask + 1ULL, sizeof(uint32_t), _Alignof(uint32_t)) ||
+		!DbcCache_Field(reader, &db->frameNameIndex, db->frameIndexMask + 1ULL, sizeof(uint32_t), _Alignof(uint32_t)) ||
+		!DbcCache_Index(db->frameIndex, db->frameIndexMask, db->frameCount) ||
+		!DbcCache_Index(db->frameNameIndex, db->frameIndexMask, db->frameCount))
+	{
+		return false;
+	}
+	for (frame = db->frames; frame < db->frames + db->frameCount; frame++)
+	{
+		if (!DbcCache_CheckFrame(reader, frame))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool DbcCache_WriteAll(int fd, const void *data, size_t size)
+{
+	const char *p = data;
+	ssize_t written;
+
+	while (size > 0)
+	{
+		written = write(fd, p, size);
+		if (written < 0 && EINTR == errno)
+		{
+			continue;
+		}
+		if (written <= 0)
+		{
+			return false;
+		}
+		p += written;
+		size -= written;
+	}
+
+	return true;
+}
+
+/**
+Section: Implementation
+*/
+
+uint64_t DbcCache_Hash(const char *data, size_t size)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL, word;
+	size_t i;
+
+	/* FNV-1a on 64 bit words, good enough to detect an edited DBC file */
+	for (i = 0; i + sizeof(word) <= size; i += sizeof(word))
+	{
+		memcpy(&word, data + i, sizeof(word));
+		hash = (hash ^ word) * 0x100000001b3ULL;
+		hash ^= hash >> 32;
+	}
+	for (; i < size; i++)
+	{
+		hash = (hash ^ (uint8_t) data[i]) * 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+int DbcCache_Save(Dbc_Database_t *db, const char *cachePath, uint64_t dbcHash, uint64_t dbcSize)
+{
+	DbcCache_Writer_t writer;
+	DbcCache_Header_t header;
+	char *tempPath;
+	int fd, ret = -1;
+
+	memset(&writer, 0, sizeof(writer));
+	memset(&header, 0, sizeof(header));
+	writer.block = (const char *) db;
+	/* At least one NUL byte follows the block, it ends the last string of a damaged cache */
+	writer.imageSize = DBC_CACHE_ALIGN(sizeof(header)) + DBC_CACHE_ALIGN(db->size + 1);
+	writer.image = calloc(1, writer.imageSize);
+	if (NULL == writer.image)
+	{
+		goto out;
+	}
+	memcpy(writer.image + DBC_CACHE_ALIGN(sizeof(header)), db, db->size);
+	((Dbc_Database_t *) (writer.image + DBC_CACHE_ALIGN(sizeof(header))))->isCached = 1;
+	DbcCache_LinkDatabase(&writer, db);
+	if (writer.failed)
+	{
+		errno = ENOMEM;
+		goto out;
+	}
+
+	memcpy(header.magic, DBC_CACHE_MAGIC, sizeof(header.magic));
+	header.version = DBC_CACHE_VERSION;
+	header.byteOrder = DBC_CACHE_BYTE_ORDER;
+	header.pointerSize = sizeof(void *);
+	header.databaseSize = sizeof(Dbc_Database_t);
+	header.frameSize = sizeof(Dbc_Frame_t);
+	header.signalSize = sizeof(Dbc_Signal_t);
+	header.valueSize = sizeof(Dbc_Value_t);
+	header.stepSize = sizeof(Dbc_DecodeStep_t);
+	header.dbcHash = dbcHash;
+	header.dbcSize = dbcSize;
+	header.imageSize = writer.imageSize;
+	header.base = DBC_CACHE_BASE;
+	header.database = DBC_CACHE_ALIGN(sizeof(header));
+	memcpy(writer.image, &header, sizeof(header));
+
+	/* Write a temporary file next to the cache and rename it over the cache */
+	tempPath = malloc(strlen(cachePath) + sizeof(".XXXXXX"));
+	if (NULL == tempPath)
+	{
+		goto out;
+	}
+	strcpy(tempPath, cachePath);
+	strcat(tempPath, ".XXXXXX");
+	fd = mkstemp(tempPath);
+	if (fd < 0)
+	{
+		free(tempPath);
+		goto out;
+	}
+	if (0 == fchmod(fd, 0644) &&
+		DbcCache_WriteAll(fd, writer.image, header.imageSize) &&
+		0 == close(fd))
+	{
+		fd = -1;
+		ret = rename(tempPath, cachePath);
+	}
+	if (0 != ret)
+	{
+		if (fd >= 0)
+		{
+			close(fd);
+		}
+		unlink(tempPath);
+	}
+	free(tempPath);
+
+out:
+	free(writer.image);
+	return ret;
+}
+
+int DbcCache_Load(Dbc_Database_t **db, const char *cachePath, uint64_t dbcHash, uint64_t dbcSize)
+{
+	const DbcCache_Header_t *header;
+	DbcCache_Reader_t reader;
+	struct stat st;
+	char *image;
+	int fd;
+
+	fd = open(cachePath, O_RDONLY);
+	if (fd < 0)
+	{
+		return -1;
+	}
+	if (0 != fstat(fd, &st) || (size_t) st.st_size < sizeof(DbcCache_Header_t))
+	{
+		close(fd);
+		return -1;
+	}
+
+	/*
+	 * Read only and private: mapped at DBC_CACHE_BASE the pages are shared with
+	 * the page cache and never written, elsewhere relocating the pointers
+	 * copies them but doesn't modify the file
+	 */
+	image = mmap((void *) DBC_CACHE_BASE, st.st_size, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == image)
+	{
+		return -1;
+	}
+
+	header = (const DbcCache_Header_t *) image;
+	if (0 != memcmp(header->magic, DBC_CACHE_MAGIC, sizeof(header->magic)) ||
+		DBC_CACHE_VERSION != header->version ||
+		DBC_CACHE_BYTE_ORDER != header->byteOrder ||
+		sizeof(void *) != header->pointerSize ||
+		sizeof(Dbc_Database_t) != header->databaseSize ||
+		sizeof(Dbc_Frame_t) != header->frameSize ||
+		sizeof(Dbc_Signal_t) != header->signalSize ||
+		sizeof(Dbc_Value_t) != header->valueSize ||
+		sizeof(Dbc_DecodeStep_t) != header->stepSize ||
+		dbcHash != header->dbcHash || dbcSize != header->dbcSize ||
+		(uint64_t) st.st_size != header->imageSize ||
+		DBC_CACHE_ALIGN(sizeof(DbcCache_Header_t)) != header->database ||
+		header->imageSize - header->database < sizeof(Dbc_Database_t) ||
+		((const Dbc_Database_t *) (image + header->database))->size >= header->imageSize - header->database ||
+		header->imageSize - header->database != DBC_CACHE_ALIGN(((const Dbc_Database_t *) (image + header->database))->size + 1) ||
+		'\0' != image[header->imageSize - 1] ||
+		(uintptr_t) header->base != header->base)
+	{
+		munmap(image, st.st_size);
+		return -1;
+	}
+
+	reader.image = image;
+	reader.imageSize = header->imageSize;
+	reader.database = header->database;
+	reader.base = header->base;
+	reader.relocate = ((uintptr_t) image != reader.base);
+	if (reader.relocate && 0 != mprotect(image, st.st_size, PROT_READ | PROT_WRITE))
+	{
+		munmap(image, st.st_size);
+		return -1;
+	}
+	if (!DbcCache_CheckDatabase(&reader, (Dbc_Database_t *) (image + header->database)) ||
+		(reader.relocate && 0 != mprotect(image, st.st_size, PROT_READ)))
+	{
+		munmap(image, st.st_size);
+		return -1;
+	}
+
+	*db = (Dbc_Database_t *) (image + header->database);
+
+	return 0;
+}
+
+void DbcCache_Unmap(Dbc_Database_t *db)
+{
+	char *image = (char *) db - DBC_CACHE_ALIGN(sizeof(DbcCache_Header_t));
+	const DbcCache_Header_t *header = (const DbcCache_Header_t *) image;
+
+	munmap(image, header->imageSize);
+}
+
+int32_t DbcCache_Init(Dbc_Database_t **db, char *dbcFilePath, const char *cachePath)
+{
+	char *contents;
+	size_t size;
+	uint64_t hash;
+	int32_t ret;
+
+	contents = Dbc_ReadFile(dbcFilePath, &size);
+	if (NULL == contents)
+	{
+		return -1;
+	}
+
+	hash = DbcCache_Hash(contents, size);
+	if (0 == DbcCache_Load(db, cachePath, hash, size))
+	{
+		free(contents);
+		return 0;
+	}
+
+	ret = Dbc_Parse(db, contents, size);
+	free(contents);
+	if (0 == ret && 0 != DbcCache_Save(*db, cachePath, hash, size))
+	{
+		fprintf(stderr, "[WARNING] Unable to write DBC cache %s: %s\n", cachePath, strerror(errno));
+	}
+
+	return ret;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file dbcCache.h
+ *
+ * Binary cache of a parsed DBC database
+ *
+ * The cache is a DbcCache_Header_t followed by a copy of the database block
+ * built by Dbc_Parse(): frames, frame indexes, signals, decode plans, value
+ * tables and strings. Pointers are linked against a mapping of the file at
+ * DBC_CACHE_BASE, so where that address is free loading the cache is one
+ * read only mmap() and a check of every pointer, count and index; elsewhere
+ * the pointers are relocated. The image uses the native byte order and
+ * structure layout; a cache built by a different build or from different DBC
+ * contents is rebuilt.
+ */
+
+#ifndef _DBCCACHE_H_
+#define _DBCCACHE_H_
+
+#include <stdint.h>
+#include "dbc.h"
+
+/**
+Section: Definitions
+*/
+
+#define DBC_CACHE_MAGIC      "CANDBCCH"
+#define DBC_CACHE_VERSION    5
+#define DBC_CACHE_BYTE_ORDER 0x01020304u  /**< Written in native byte order */
+#define DBC_CACHE_ALIGNMENT  16
+
+/** Preferred address of the mapping, above the executable and below the shared libraries */
+#if UINTPTR_MAX > 0xffffffffu
+#define DBC_CACHE_BASE       ((uintptr_t) 0x5dbc00000000ULL)
+#else
+#define DBC_CACHE_BASE       ((uintptr_t) 0x5dbc0000u)
+#endif
+
+/** Size rounded up to the alignment of all objects in the image */
+#define DBC_CACHE_ALIGN(size) (((size) + DBC_CACHE_ALIGNMENT - 1) & ~(size_t) (DBC_CACHE_ALIGNMENT - 1))
+
+/**
+Section: Public Types
+*/
+
+typedef struct
+{
+	char magic[8];           /**< DBC_CACHE_MAGIC, not NUL terminated */
+	uint32_t version;
+	uint32_t byteOrder;      /**< DBC_CACHE_BYTE_ORDER */
+	uint32_t pointerSize;    /**< Layout of the build that wrote the cache */
+	uint32_t databaseSize;
+	uint32_t frameSize;
+	uint32_t signalSize;
+	uint32_t valueSize;
+	uint32_t stepSize;
+	uint64_t dbcHash;        /**< Hash of the DBC file contents */
+	uint64_t dbcSize;        /**< Size of the DBC file contents */
+	uint64_t imageSize;      /**< Header and database, the size of the file */
+	uint64_t base;           /**< Address the pointers are linked against */
+	uint64_t database;       /**< Offset of the database block */
+} DbcCache_Header_t;
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Like Dbc_Init(), but maps the database from a cache file
+ *
+ * The cache is used if it was built from the same DBC contents by the same
+ * build. Otherwise the DBC file is parsed and the cache is (re)written, which
+ * only prints a warning if it fails.
+ *
+ * @param      db[out]          The database, to be freed by Dbc_DeInit()
+ * @param      dbcFilePath[in]  The dbc file path
+ * @param      cachePath[in]    The cache file path
+ *
+ * @return     0 on success and a negative value otherwise
+ */
+int32_t DbcCache_Init(Dbc_Database_t **db, char *dbcFilePath, const char *cachePath);
+
+/**
+ * @brief      Writes a parsed database to a cache file
+ *
+ * The file is replaced atomically, so concurrent readers see either the old
+ * or the new cache.
+ *
+ * @param[in]  db         The database, as built by Dbc_Parse()
+ * @param[in]  cachePath  The cache file path
+ * @param[in]  dbcHash    Hash of the DBC contents, see DbcCache_Hash()
+ * @param[in]  dbcSize    Size of the DBC contents
+ *
+ * @return     0 on success and a negative value otherwise (errno is set)
+ */
+int DbcCache_Save(Dbc_Database_t *db, const char *cachePath, uint64_t dbcHash, uint64_t dbcSize);
+
+/**
+ * @brief      Maps a database from a cache file
+ *
+ * @param      db[out]     The database
+ * @param[in]  cachePath   The cache file path
+ * @param[in]  dbcHash     Expected hash of the DBC contents
+ * @param[in]  dbcSize     Expected size of the DBC contents
+ *
+ * @return     0 on success and a negative value if there is no valid cache for the DBC
+ */
+int DbcCache_Load(Dbc_Database_t **db, const char *cachePath, uint64_t dbcHash, uint64_t dbcSize);
+
+/**
+ * @brief      Unmaps a database loaded by DbcCache_Load(), called by Dbc_DeInit()
+ *
+ * @param      db    The database
+ */
+void DbcCache_Unmap(Dbc_Database_t *db);
+
+/**
+ * @brief      Hashes DBC file contents to detect a stale cache
+ *
+ * @param[in]  data  The contents
+ * @param[in]  size  Size of the contents
+ *
+ * @return     The hash
+ */
+uint64_t DbcCache_Hash(const char *data, size_t size);
+
+#endif
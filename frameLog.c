@@ -0,0 +1,243 @@
+/**
+ * @file frameLog.c
+ *
+ * Binary frame log with fixed size records
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <endian.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "frameLog.h"
+
+/**
+Section: Private functions
+*/
+
+/**
+ * @brief      Returns the table index of an interface, adding it if needed
+ *
+ * @return     The index or a negative value if the name is too long or the table is full
+ */
+static int FrameLog_InterfaceIndex(FrameLog_Writer_t *writer, const char *device)
+{
+	FrameLog_Header_t *header = &writer->header;
+	unsigned int i;
+
+	if (writer->lastInterface < header->interfaceCount && 0 == strcmp(header->interfaces[writer->lastInterface], device))
+	{
+		return writer->lastInterface;
+	}
+
+	for (i = 0; i < header->interfaceCount; i++)
+	{
+		if (0 == strcmp(header->interfaces[i], device))
+		{
+			break;
+		}
+	}
+	if (i == header->interfaceCount)
+	{
+		if (FRAME_LOG_MAX_INTERFACES == i || strlen(device) >= IF_NAMESIZE)
+		{
+			return -1;
+		}
+		strcpy(header->interfaces[i], device);
+		header->interfaceCount++;
+	}
+	writer->lastInterface = i;
+
+	return i;
+}
+
+/**
+Section: Implementation
+*/
+
+int FrameLog_Create(FrameLog_Writer_t *writer, const char *path)
+{
+	memset(writer, 0, sizeof(FrameLog_Writer_t));
+	memcpy(writer->header.magic, FRAME_LOG_MAGIC, sizeof(writer->header.magic));
+	writer->header.version = FRAME_LOG_VERSION;
+	writer->header.recordSize = sizeof(FrameLog_Record_t);
+
+	writer->file = fopen(path, "wb");
+	if (NULL == writer->file)
+	{
+		return -1;
+	}
+
+	/* Placeholder, rewritten with the interface table by FrameLog_Close() */
+	if (1 != fwrite(&writer->header, sizeof(FrameLog_Header_t), 1, writer->file))
+	{
+		fclose(writer->file);
+		writer->file = NULL;
+		return -1;
+	}
+
+	return 0;
+}
+
+int FrameLog_Write(FrameLog_Writer_t *writer, const struct canfd_frame *cf, __u64 timestamp, const char *device)
+{
+	FrameLog_Record_t record, padded[FRAME_LOG_EXTENSION_RECORDS(CANFD_MAX_DLEN)];
+	unsigned int length = (cf->len > CANFD_MAX_DLEN) ? CANFD_MAX_DLEN : cf->len;
+	unsigned int extension;
+	int interface;
+
+	interface = FrameLog_InterfaceIndex(writer, device);
+	if (interface < 0)
+	{
+		errno = EINVAL;
+		return -1;
+	}
+
+	record.timestamp = htole64(timestamp);
+	record.canID = htole32(cf->can_id);
+	record.interface = interface;
+	record.flags = cf->flags;
+	record.length = length;
+	record.reserved = 0;
+	memcpy(record.data, cf->data, sizeof(record.data));
+	if (1 != fwrite(&record, sizeof(record), 1, writer->file))
+	{
+		return -1;
+	}
+
+	/* The rest of a CAN FD payload, padded to whole records */
+	if (length > sizeof(record.data))
+	{
+		extension = FRAME_LOG_EXTENSION_RECORDS(length);
+		memset(padded, 0, sizeof(padded));
+		memcpy(padded, cf->data + sizeof(record.data), length - sizeof(record.data));
+		if (extension != fwrite(padded, sizeof(record), extension, writer->file))
+		{
+			return -1;
+		}
+	}
+	writer->frames++;
+
+	return 0;
+}
+
+int FrameLog_Close(FrameLog_Writer_t *writer)
+{
+	FrameLog_Header_t header = writer->header;
+	int ret = 0;
+
+	header.version = htole16(header.version);
+	header.recordSize = htole16(header.recordSize);
+	header.interfaceCount = htole16(header.interfaceCount);
+
+	if (0 != fseek(writer->file, 0, SEEK_SET) || 1 != fwrite(&header, sizeof(header), 1, writer->file))
+	{
+		ret = -1;
+	}
+	if (0 != fclose(writer->file))
+	{
+		ret = -1;
+	}
+	writer->file = NULL;
+
+	return ret;
+}
+
+int FrameLog_ProcessFile(const char *path, FrameHandler_t handler, void *context)
+{
+	char interfaces[FRAME_LOG_MAX_INTERFACES][IF_NAMESIZE];
+	const FrameLog_Header_t *header;
+	const FrameLog_Record_t *record, *end;
+	struct canfd_frame cf;
+	unsigned int interfaceCount, length, i;
+	struct stat st;
+	void *map;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		return -1;
+	}
+	if (fstat(fd, &st) < 0)
+	{
+		close(fd);
+		return -1;
+	}
+	if ((size_t) st.st_size < sizeof(FrameLog_Header_t))
+	{
+		close(fd);
+		return FRAME_LOG_NOT_A_LOG;
+	}
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (MAP_FAILED == map)
+	{
+		return -1;
+	}
+
+	header = map;
+	if (0 != memcmp(header->magic, FRAME_LOG_MAGIC, sizeof(header->magic)))
+	{
+		munmap(map, st.st_size);
+		return FRAME_LOG_NOT_A_LOG;
+	}
+	interfaceCount = le16toh(header->interfaceCount);
+	if (FRAME_LOG_VERSION != le16toh(header->version) || sizeof(FrameLog_Record_t) != le16toh(header->recordSize) ||
+		interfaceCount > FRAME_LOG_MAX_INTERFACES)
+	{
+		munmap(map, st.st_size);
+		return -1;
+	}
+	madvise(map, st.st_size, MADV_SEQUENTIAL);
+
+	/* The callbacks take writable names */
+	memcpy(interfaces, header->interfaces, sizeof(interfaces));
+	for (i = 0; i < interfaceCount; i++)
+	{
+		interfaces[i][IF_NAMESIZE - 1] = '\0';
+	}
+
+	record = (const FrameLog_Record_t *) (header + 1);
+	end = record + (st.st_size - sizeof(FrameLog_Header_t)) / sizeof(FrameLog_Record_t);
+	memset(&cf, 0, sizeof(cf));
+	while (record < end)
+	{
+		length = record->length;
+		if (record->interface >= interfaceCount || length > CANFD_MAX_DLEN ||
+			(size_t) (end - record - 1) < FRAME_LOG_EXTENSION_RECORDS(length))
+		{
+			munmap(map, st.st_size);
+			return -1;
+		}
+
+		cf.can_id = le32toh(record->canID);
+		cf.flags = record->flags;
+		memcpy(cf.data, record->data, sizeof(record->data));
+		if (length > sizeof(record->data))
+		{
+			memcpy(cf.data + sizeof(record->data), record + 1, length - sizeof(record->data));
+			memset(cf.data + length, 0, CANFD_MAX_DLEN - length);
+		}
+		else if (cf.len > sizeof(record->data))
+		{
+			/* Clear what the last CAN FD frame left behind */
+			memset(cf.data + sizeof(record->data), 0, CANFD_MAX_DLEN - sizeof(record->data));
+		}
+		cf.len = length;
+
+		handler(&cf, le64toh(record->timestamp), interfaces[record->interface], context);
+		record += 1 + FRAME_LOG_EXTENSION_RECORDS(length);
+	}
+
+	munmap(map, st.st_size);
+	return 0;
+}
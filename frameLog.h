@@ -0,0 +1,113 @@
+/**
+ * @file frameLog.h
+ *
+ * Binary frame log with fixed size records
+ *
+ * A log starts with a FrameLog_Header_t holding the interface name table,
+ * followed by FrameLog_Record_t records. A record carries up to 8 payload
+ * bytes; the rest of a CAN FD payload follows in as many extension records
+ * as needed. All fields are little endian.
+ */
+
+#ifndef _FRAMELOG_H_
+#define _FRAMELOG_H_
+
+#include <stdio.h>
+#include <stdint.h>
+#include <net/if.h>
+#include <linux/can.h>
+#include "socketInput.h"
+
+/**
+Section: Definitions
+*/
+
+#define FRAME_LOG_MAGIC          "CANFRLOG"
+#define FRAME_LOG_VERSION        1
+#define FRAME_LOG_MAX_INTERFACES 32
+#define FRAME_LOG_NOT_A_LOG      1  /**< FrameLog_ProcessFile(): the file has no frame log header */
+
+/** Extension records following a record with a payload of length bytes */
+#define FRAME_LOG_EXTENSION_RECORDS(length) \
+	(((length) > 8) ? ((length) - 8 + sizeof(FrameLog_Record_t) - 1) / sizeof(FrameLog_Record_t) : 0)
+
+/**
+Section: Public Types
+*/
+
+typedef struct
+{
+	char magic[8];        /**< FRAME_LOG_MAGIC, not NUL terminated */
+	uint16_t version;
+	uint16_t recordSize;  /**< sizeof(FrameLog_Record_t) */
+	uint16_t interfaceCount;
+	uint16_t reserved;
+	char interfaces[FRAME_LOG_MAX_INTERFACES][IF_NAMESIZE];  /**< NUL terminated names */
+} FrameLog_Header_t;
+
+typedef struct
+{
+	uint64_t timestamp;   /**< Nanoseconds */
+	uint32_t canID;       /**< SocketCAN ID including the EFF/RTR/ERR flags */
+	uint8_t interface;    /**< Index into the interface table */
+	uint8_t flags;        /**< canfd_frame flags, CANFD_FDF for CAN FD frames */
+	uint8_t length;       /**< Payload length, more than 8 bytes continue in extension records */
+	uint8_t reserved;
+	uint8_t data[8];
+} FrameLog_Record_t;
+
+typedef struct
+{
+	FILE *file;
+	FrameLog_Header_t header;
+	unsigned int lastInterface;  /**< Index of the last written interface, checked first */
+	unsigned long frames;
+} FrameLog_Writer_t;
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Creates a frame log; the interface table is written on close
+ *
+ * @param      writer  The writer
+ * @param[in]  path    The file path, must be seekable
+ *
+ * @return     0 on success and a negative value otherwise (errno is set)
+ */
+int FrameLog_Create(FrameLog_Writer_t *writer, const char *path);
+
+/**
+ * @brief      Appends one frame
+ *
+ * @param      writer     The writer
+ * @param[in]  cf         The frame
+ * @param[in]  timestamp  Timestamp in nanoseconds
+ * @param[in]  device     Interface name, up to IF_NAMESIZE - 1 characters
+ *
+ * @return     0 on success and a negative value otherwise
+ */
+int FrameLog_Write(FrameLog_Writer_t *writer, const struct canfd_frame *cf, __u64 timestamp, const char *device);
+
+/**
+ * @brief      Writes the interface table and closes the log
+ *
+ * @param      writer  The writer
+ *
+ * @return     0 on success and a negative value otherwise
+ */
+int FrameLog_Close(FrameLog_Writer_t *writer);
+
+/**
+ * @brief      Maps a frame log and passes all frames to handler
+ *
+ * @param[in]  path     The file path
+ * @param[in]  handler  Called for every frame, in file order
+ * @param      context  Passed to handler
+ *
+ * @return     0 on success, FRAME_LOG_NOT_A_LOG if the file isn't a frame log and a negative value otherwise
+ */
+int FrameLog_ProcessFile(const char *path, FrameHandler_t handler, void *context);
+
+#endif
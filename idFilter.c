@@ -0,0 +1,110 @@
+/**
+ * @file idFilter.c
+ *
+ * Set of accepted CAN IDs, checked before a frame is fully parsed
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include "idFilter.h"
+
+/**
+Section: Definitions
+*/
+
+#define ID_FILTER_MIN_SIZE 16
+
+/**
+Section: Private functions
+*/
+
+static void IdFilter_Insert(canid_t *slots, uint32_t size, uint8_t shift, canid_t canID)
+{
+	uint32_t slot;
+
+	for (slot = (canID * ID_FILTER_HASH_MULT) >> shift; 0 != slots[slot]; slot = (slot + 1) & (size - 1))
+	{
+		if (slots[slot] == canID)
+		{
+			return;
+		}
+	}
+	slots[slot] = canID;
+}
+
+/**
+ * @brief      Doubles the hash set, keeping it at most half full
+ */
+static int IdFilter_Grow(IdFilter_t *filter)
+{
+	uint32_t size = filter->otherSize ? filter->otherSize * 2 : ID_FILTER_MIN_SIZE;
+	uint8_t shift = 32;
+	canid_t *slots;
+	uint32_t i;
+
+	for (i = size; i > 1; i >>= 1)
+	{
+		shift--;
+	}
+	slots = calloc(size, sizeof(canid_t));
+	if (NULL == slots)
+	{
+		return -1;
+	}
+	for (i = 0; i < filter->otherSize; i++)
+	{
+		if (0 != filter->other[i])
+		{
+			IdFilter_Insert(slots, size, shift, filter->other[i]);
+		}
+	}
+
+	free(filter->other);
+	filter->other = slots;
+	filter->otherSize = size;
+	filter->otherShift = shift;
+
+	return 0;
+}
+
+/**
+Section: Implementation
+*/
+
+void IdFilter_Init(IdFilter_t *filter)
+{
+	memset(filter, 0, sizeof(IdFilter_t));
+}
+
+void IdFilter_DeInit(IdFilter_t *filter)
+{
+	free(filter->other);
+	memset(filter, 0, sizeof(IdFilter_t));
+}
+
+int IdFilter_Add(IdFilter_t *filter, canid_t canID)
+{
+	canID = Dbc_NormalizeId(canID);
+	if (canID <= CAN_SFF_MASK)
+	{
+		filter->sff[canID / 64] |= 1ULL << (canID % 64);
+		return 0;
+	}
+	if (IdFilter_Contains(filter, canID))
+	{
+		return 0;
+	}
+
+	if (2 * (filter->otherCount + 1) > filter->otherSize && IdFilter_Grow(filter))
+	{
+		return -1;
+	}
+	IdFilter_Insert(filter->other, filter->otherSize, filter->otherShift, canID);
+	filter->otherCount++;
+
+	return 0;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file idFilter.h
+ *
+ * Set of accepted CAN IDs, checked before a frame is fully parsed
+ */
+
+#ifndef _IDFILTER_H_
+#define _IDFILTER_H_
+
+#include <stdint.h>
+#include <linux/can.h>
+#include "dbc.h"
+
+/**
+Section: Definitions
+*/
+
+#define ID_FILTER_SFF_WORDS  ((CAN_SFF_MASK + 1) / 64)
+#define ID_FILTER_HASH_MULT  0x9E3779B1u  /* Fibonacci hashing */
+
+/**
+Section: Public Types
+*/
+
+typedef struct
+{
+	uint64_t sff[ID_FILTER_SFF_WORDS];  /**< One bit per standard ID */
+	canid_t *other;                     /**< Open addressing set of all other IDs, 0 marks free slots */
+	uint32_t otherSize;                 /**< Slots, power of two or 0 */
+	uint32_t otherCount;
+	uint8_t otherShift;                 /**< 32 - log2(otherSize) */
+} IdFilter_t;
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Initializes an empty filter, rejecting all IDs
+ *
+ * @param      filter  The filter
+ */
+void IdFilter_Init(IdFilter_t *filter);
+
+/**
+ * @brief      Frees a filter
+ *
+ * @param      filter  The filter
+ */
+void IdFilter_DeInit(IdFilter_t *filter);
+
+/**
+ * @brief      Accepts an ID
+ *
+ * @param      filter  The filter
+ * @param[in]  canID   The DBC or SocketCAN frame ID
+ *
+ * @return     0 on success and a negative value otherwise
+ */
+int IdFilter_Add(IdFilter_t *filter, canid_t canID);
+
+/**
+Section: Inline Functions
+*/
+
+/**
+ * @brief      Checks whether an ID was added to the filter
+ *
+ * Remote and error frames are never accepted, they carry no signals.
+ *
+ * @param[in]  filter  The filter
+ * @param[in]  canID   The SocketCAN frame ID
+ *
+ * @return     1 if the ID is accepted, 0 otherwise
+ */
+static inline int IdFilter_Contains(const IdFilter_t *filter, canid_t canID)
+{
+	uint32_t slot;
+
+	if (!Dbc_IsDataFrame(canID))
+	{
+		return 0;
+	}
+	canID = Dbc_NormalizeId(canID);
+	if (canID <= CAN_SFF_MASK)
+	{
+		return (filter->sff[canID / 64] >> (canID % 64)) & 1;
+	}
+	if (0 == filter->otherCount)
+	{
+		return 0;
+	}
+
+	for (slot = (canID * ID_FILTER_HASH_MULT) >> filter->otherShift; 0 != filter->other[slot]; slot = (slot + 1) & (filter->otherSize - 1))
+	{
+		if (filter->other[slot] == canID)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+#endif
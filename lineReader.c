@@ -0,0 +1,136 @@
+/**
+ * @file lineReader.c
+ *
+ * Block buffered line input
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "lineReader.h"
+
+/**
+Section: Private functions
+*/
+
+/**
+ * @brief      Makes room behind the valid data and reads the next block
+ *
+ * @param      reader  The reader
+ *
+ * @return     0 on success (check eof) and a negative value otherwise
+ */
+static int LineReader_Fill(LineReader_t *reader);
+
+/**
+Section: Implementation
+*/
+
+int LineReader_Init(LineReader_t *reader, int fd, size_t blockSize)
+{
+	reader->buffer = malloc(blockSize);
+	if (NULL == reader->buffer)
+	{
+		return -1;
+	}
+
+	reader->fd = fd;
+	reader->size = blockSize;
+	reader->start = 0;
+	reader->scan = 0;
+	reader->end = 0;
+	reader->eof = 0;
+
+	return 0;
+}
+
+void LineReader_DeInit(LineReader_t *reader)
+{
+	free(reader->buffer);
+	reader->buffer = NULL;
+}
+
+static int LineReader_Fill(LineReader_t *reader)
+{
+	ssize_t ret;
+	char *buffer;
+
+	/* Move the partial line to the front, it straddles the block boundary */
+	if (reader->start > 0)
+	{
+		memmove(reader->buffer, reader->buffer + reader->start, reader->end - reader->start);
+		reader->end -= reader->start;
+		reader->scan -= reader->start;
+		reader->start = 0;
+	}
+
+	/* The whole buffer is one line, grow it */
+	if (reader->end == reader->size)
+	{
+		buffer = realloc(reader->buffer, reader->size * 2);
+		if (NULL == buffer)
+		{
+			return -1;
+		}
+		reader->buffer = buffer;
+		reader->size *= 2;
+	}
+
+	do
+	{
+		ret = read(reader->fd, reader->buffer + reader->end, reader->size - reader->end);
+	} while (ret < 0 && EINTR == errno);
+
+	if (ret < 0)
+	{
+		return -1;
+	}
+	if (0 == ret)
+	{
+		reader->eof = 1;
+	}
+	reader->end += ret;
+
+	return 0;
+}
+
+int LineReader_Next(LineReader_t *reader, char **line, size_t *length)
+{
+	char *newline;
+
+	for (;;)
+	{
+		newline = memchr(reader->buffer + reader->scan, '\n', reader->end - reader->scan);
+		if (NULL != newline)
+		{
+			*line = reader->buffer + reader->start;
+			*length = newline - *line;
+			reader->start = reader->scan = newline - reader->buffer + 1;
+			return 1;
+		}
+		reader->scan = reader->end;
+
+		if (reader->eof)
+		{
+			if (reader->start == reader->end)
+			{
+				return 0;
+			}
+			/* Last line without line end */
+			*line = reader->buffer + reader->start;
+			*length = reader->end - reader->start;
+			reader->start = reader->scan = reader->end;
+			return 1;
+		}
+
+		if (LineReader_Fill(reader))
+		{
+			return -1;
+		}
+	}
+}
@@ -0,0 +1,70 @@
+/**
+ * @file lineReader.h
+ *
+ * Block buffered line input
+ */
+
+#ifndef _LINEREADER_H_
+#define _LINEREADER_H_
+
+#include <stddef.h>
+
+/**
+Section: Definitions
+*/
+
+#define LINE_READER_BLOCK_SIZE (1 << 20)
+
+/**
+Section: Public Types
+*/
+
+typedef struct
+{
+	int fd;
+	char *buffer;
+	size_t size;   /**< Allocated size of buffer */
+	size_t start;  /**< First byte not yet handed out */
+	size_t scan;   /**< First byte not yet searched for a line end */
+	size_t end;    /**< End of valid data */
+	int eof;
+} LineReader_t;
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Prepares a reader for a file descriptor
+ *
+ * @param      reader     The reader
+ * @param[in]  fd         The file descriptor, read with read() in large blocks
+ * @param[in]  blockSize  Initial buffer size; grows if a line doesn't fit
+ *
+ * @return     0 on success and a negative value otherwise
+ */
+int LineReader_Init(LineReader_t *reader, int fd, size_t blockSize);
+
+/**
+ * @brief      Frees the buffer of a reader, the file descriptor is not closed
+ *
+ * @param      reader  The reader
+ */
+void LineReader_DeInit(LineReader_t *reader);
+
+/**
+ * @brief      Returns the next line without copying it
+ *
+ * The line points into the reader buffer and stays valid until the next
+ * call. It may be modified in place. The line end is not included; the last
+ * line doesn't need a line end.
+ *
+ * @param      reader  The reader
+ * @param[out] line    Start of the line
+ * @param[out] length  Length of the line
+ *
+ * @return     1 if a line was returned, 0 at end of input and a negative value on read errors
+ */
+int LineReader_Next(LineReader_t *reader, char **line, size_t *length);
+
+#endif
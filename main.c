@@ -1,155 +1,746 @@
-/**
- * @file main.c
- *
- * candecode App
- */
-
-/**
-Section: Included Files
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include "dbc.h"
-#include "processFrame.h"
-
-/**
-Section: Definitions
-*/
-
-#define MAX_LINE_SIZE 100
-#define MAX_DEVICE_NAME 100
-#define MAX_ASC_FRAME 100
-
-/**
-Section: Implementation
-*/
-
-void printCallback(const char *frameName, const char *signalName, __u64 rawValue, const char *stringValue, double scaledValue, struct timeval tv, char *device)
-{
-	if (NULL == signalName || NULL == frameName)
-	{
-		printf("(%04ld.%06ld) %s: Frame 0x%02llx not found\n", tv.tv_sec, tv.tv_usec, device, rawValue);
-	}
-	else if (NULL != stringValue)
-	{
-		printf("(%04ld.%06ld) %s %s.%s: 0x%02llx \"%s\"\n", tv.tv_sec, tv.tv_usec, device, frameName, signalName, rawValue, stringValue);
-	}
-	else
-	{
-		printf("(%04ld.%06ld) %s %s.%s: 0x%02llx %f\n", tv.tv_sec, tv.tv_usec, device, frameName, signalName, rawValue, scaledValue);
-	}
-}
-
-int main(int argc, char **argv)
-{
-	int process_all = 0;
-	char buf[MAX_LINE_SIZE], device[MAX_DEVICE_NAME], ascframe[MAX_ASC_FRAME];
-
-	char *frameName, *signalName;
-	struct can_frame cf;
-	struct timeval tv;
-
-	Dbc_Frame_t *database = NULL;
-	signal_callback_list_t *callbackList = NULL;
-	Dbc_Signal_t *mySignal;
-	Dbc_Frame_t *myFrame;
-
-	if (argc < 2)
-	{
-		fprintf(stderr, "Usage:\n");
-		fprintf(stderr, "%s Database [all]  # processes all frames\n", argv[0]);
-		fprintf(stderr, "%s Database Message1.Signal1 [Message2.Signal2 Message3.Signal3]\n", argv[0]);
-		exit(EXIT_FAILURE);
-	}
-
-	/* Read DBC */
-	if (Dbc_Init(&database, argv[1]))
-	{
-		fprintf(stderr, "[ERROR] Unable to open database %s\n", argv[1]);
-		exit(EXIT_FAILURE);
-	}
-	argc--;
-	argv++;
-
-	/* Decode all frames none were provided */
-	if (argc == 1)
-	{
-		process_all = 1;
-	}
-
-	/* Parse arguments (frames/signals which should be decoded) */
-	while (argc >= 2)
-	{
-		frameName = argv[1];
-		if (strcmp(frameName, "all") == 0)
-		{
-			process_all = 1;
-			break;
-		}
-
-		signalName = strchr(argv[1], '.');
-
-		printf("Trying to find: Frame: %s", frameName);
-		if (signalName != NULL)
-		{
-			*signalName = 0;
-			signalName++;
-			printf(", Signal: %s", signalName);
-		}
-		printf("\n");
-		myFrame = Dbc_FindFrameByName(database, frameName);
-
-		if (!myFrame)
-		{
-			fprintf(stderr, "[ERROR] Unable to find frame %s\n", frameName);
-			exit(EXIT_FAILURE);
-		}
-
-		if (NULL != signalName)
-		{
-			mySignal = Dbc_FindSignalByName(myFrame, signalName);
-			if (!mySignal)
-			{
-				fprintf(stderr, "[ERROR] Unable to find signal %s\n", signalName);
-				exit(EXIT_FAILURE);
-			}
-		}
-		else
-		{
-			mySignal = NULL;
-		}
-		add_callback(&callbackList, myFrame, mySignal, printCallback, 0);
-
-		printf("-- %s (0x%03x) ", myFrame->name, myFrame->canID);
-		if (signalName != NULL)
-			printf(" %s (%d [%d]) --", mySignal->name, mySignal->startBit, mySignal->signalLength);
-		printf("\n");
-		argc--;
-		argv++;
-	}
-
-	while (fgets(buf, MAX_LINE_SIZE - 1, stdin))
-	{
-
-		if (sscanf(buf, "(%ld.%ld) %s %s", &tv.tv_sec, &tv.tv_usec, device, ascframe) != 4)
-		{
-			fprintf(stderr, "[ERROR] Incorrect line format in logfile\n");
-			exit(EXIT_FAILURE);
-		}
-		if (parse_canframe(ascframe, &cf))
-		{
-			fprintf(stderr, "[ERROR] Unable to parse CAN frame from ASCII representation\n");
-			exit(EXIT_FAILURE);
-		}
-
-		if (process_all)
-			processAllFrames(database, printCallback, &cf, tv, device);
-		else
-			processFrame(callbackList, &cf, tv, device);
-	}
-
-	Dbc_DeInit(database);
-	delete_callbacks(callbackList);
-	return 0;
-}
+/**
+ * @file main.c
+ *
+ * candecode App
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include "dbc.h"
+#include "dbcCache.h"
+#include "processFrame.h"
+#include "parseLine.h"
+#include "lineReader.h"
+#include "chunkedInput.h"
+#include "pipeline.h"
+#include "socketInput.h"
+#include "frameLog.h"
+#include "compressedInput.h"
+
+/**
+Section: Definitions
+*/
+
+#define NSEC_PER_SEC 1000000000ULL
+#define NSEC_PER_USEC 1000ULL
+#define MAX_DEVICE_NAME 256
+#define MAX_INPUT_FILES 64
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	Dbc_Database_t *database;
+	signal_callback_list_t *callbackList;
+	callback_t callback;
+	int process_all;
+	const IdFilter_t *filter;  /* Subscribed IDs, NULL in all mode */
+	FrameLog_Writer_t *writer;  /* Frames are written to a frame log instead of being decoded */
+	int print_frames;           /* Frames are printed as candump -L text instead of being decoded */
+} decoder_t;
+
+/* Subscription of the signals matched by a selector */
+typedef struct
+{
+	signal_callback_list_t **callbackList;
+	callback_t callback;
+	__u8 reportMode;
+	double deadband;
+} selection_t;
+
+/**
+Section: Private data
+*/
+
+/* Output of the decoding thread: stdout or the memory stream of a chunk */
+static __thread FILE *output;
+
+/**
+Section: Implementation
+*/
+
+/* Only interrupts blocking receives, so statistics are printed on exit */
+static void interruptHandler(int signum)
+{
+	(void) signum;
+}
+
+void printCallback(const decoded_signal_t *decoded, __u64 timestamp, char *device)
+{
+	const char *stringValue;
+
+	if (NULL == decoded->frame)
+	{
+		fprintf(output, "(%04llu.%06llu) %s: Frame 0x%02x not found\n", timestamp / NSEC_PER_SEC, (timestamp % NSEC_PER_SEC) / NSEC_PER_USEC, device, decoded->canID);
+		return;
+	}
+
+	stringValue = decoded_value_string(decoded);
+	if (NULL != stringValue)
+	{
+		fprintf(output, "(%04llu.%06llu) %s %s.%s: 0x%02llx \"%s\"\n", timestamp / NSEC_PER_SEC, (timestamp % NSEC_PER_SEC) / NSEC_PER_USEC, device,
+			decoded->frame->name, Dbc_StepSignal(decoded->frame, decoded->step)->name, decoded->rawValue, stringValue);
+	}
+	else
+	{
+		fprintf(output, "(%04llu.%06llu) %s %s.%s: 0x%02llx %f\n", timestamp / NSEC_PER_SEC, (timestamp % NSEC_PER_SEC) / NSEC_PER_USEC, device,
+			decoded->frame->name, Dbc_StepSignal(decoded->frame, decoded->step)->name, decoded->rawValue, decoded_physical_value(decoded));
+	}
+}
+
+/* Raw values only, never scales or looks up value strings */
+void printRawCallback(const decoded_signal_t *decoded, __u64 timestamp, char *device)
+{
+	if (NULL == decoded->frame)
+	{
+		fprintf(output, "(%04llu.%06llu) %s: Frame 0x%02x not found\n", timestamp / NSEC_PER_SEC, (timestamp % NSEC_PER_SEC) / NSEC_PER_USEC, device, decoded->canID);
+		return;
+	}
+
+	fprintf(output, "(%04llu.%06llu) %s %s.%s: 0x%02llx\n", timestamp / NSEC_PER_SEC, (timestamp % NSEC_PER_SEC) / NSEC_PER_USEC, device,
+		decoded->frame->name, Dbc_StepSignal(decoded->frame, decoded->step)->name, decoded->rawValue);
+}
+
+/* candump -L format */
+static void printFrame(const struct canfd_frame *cf, __u64 timestamp, const char *device)
+{
+	static const char hexDigits[] = "0123456789ABCDEF";
+	char line[2 * CANFD_MAX_DLEN + 4];
+	unsigned int i, length = 0;
+
+	fprintf(output, "(%010llu.%06llu) %s ", timestamp / NSEC_PER_SEC, (timestamp % NSEC_PER_SEC) / NSEC_PER_USEC, device);
+	if (cf->can_id & CAN_ERR_FLAG)
+		fprintf(output, "%08X#", cf->can_id & (CAN_ERR_MASK | CAN_ERR_FLAG));
+	else if (cf->can_id & CAN_EFF_FLAG)
+		fprintf(output, "%08X#", cf->can_id & CAN_EFF_MASK);
+	else
+		fprintf(output, "%03X#", cf->can_id & CAN_SFF_MASK);
+
+	if (cf->flags & CANFD_FDF)
+	{
+		line[length++] = '#';
+		line[length++] = hexDigits[cf->flags & ~CANFD_FDF & 0x0F];
+	}
+	else if (cf->can_id & CAN_RTR_FLAG)
+	{
+		line[length++] = 'R';
+	}
+	for (i = 0; i < cf->len && i < CANFD_MAX_DLEN; i++)
+	{
+		line[length++] = hexDigits[cf->data[i] >> 4];
+		line[length++] = hexDigits[cf->data[i] & 0x0F];
+	}
+	line[length++] = '\n';
+	fwrite(line, 1, length, output);
+}
+
+/* Decodes, converts or prints one selected frame */
+static void decodeFrame(const struct canfd_frame *cf, __u64 timestamp, char *device, void *context)
+{
+	const decoder_t *decoder = context;
+
+	if (NULL != decoder->writer)
+	{
+		if (FrameLog_Write(decoder->writer, cf, timestamp, device))
+		{
+			fprintf(stderr, "[ERROR] Unable to write frame log: %s\n", strerror(errno));
+			exit(EXIT_FAILURE);
+		}
+	}
+	else if (decoder->print_frames)
+		printFrame(cf, timestamp, device);
+	else if (decoder->process_all)
+		processAllFrames(decoder->database, decoder->callback, cf, timestamp, device);
+	else
+		processFrame(decoder->callbackList, cf, timestamp, device);
+}
+
+/* FrameHandler_t for frames received from a socket or read from a frame log, which aren't filtered yet */
+static void decodeSelectedFrame(const struct canfd_frame *cf, __u64 timestamp, char *device, void *context)
+{
+	const decoder_t *decoder = context;
+
+	if (NULL != decoder->filter && !IdFilter_Contains(decoder->filter, cf->can_id))
+	{
+		return;
+	}
+	decodeFrame(cf, timestamp, device, context);
+}
+
+/* Returns a negative value if the line is malformed */
+static int decodeLine(const decoder_t *decoder, const char *line, size_t length)
+{
+	char device[MAX_DEVICE_NAME];
+	const char *deviceName;
+	size_t deviceLength;
+	struct canfd_frame cf;
+	__u64 timestamp;
+	int ret;
+
+	ret = parseLine(line, length, decoder->filter, &timestamp, &deviceName, &deviceLength, &cf);
+	if (PARSE_LINE_REJECTED == ret)
+	{
+		return 0;
+	}
+	if (ret || deviceLength >= MAX_DEVICE_NAME)
+	{
+		return -1;
+	}
+	memcpy(device, deviceName, deviceLength);
+	device[deviceLength] = '\0';
+
+	decodeFrame(&cf, timestamp, device, (void *) decoder);
+	return 0;
+}
+
+/* ChunkHandler_t, runs on the worker threads of ChunkedInput_ProcessFile(); stops at a malformed line */
+static int decodeChunk(const char *data, size_t length, FILE *chunkOutput, void *context)
+{
+	const char *end = data + length;
+	const char *newline;
+
+	output = chunkOutput;
+	while (data < end)
+	{
+		newline = memchr(data, '\n', end - data);
+		if (NULL == newline)
+		{
+			newline = end;
+		}
+		if (decodeLine(context, data, newline - data))
+		{
+			return -1;
+		}
+		data = newline + 1;
+	}
+
+	return 0;
+}
+
+/* Installs a kernel filter for all subscribed frames */
+static int setSocketFilter(SocketInput_t *socketInput, signal_callback_list_t *callbackList)
+{
+	signal_callback_list_t *item;
+	canid_t *ids;
+	unsigned int count = 0;
+	int ret;
+
+	ids = malloc((HASH_COUNT(callbackList) + 1) * sizeof(canid_t));
+	if (NULL == ids)
+	{
+		return -1;
+	}
+	for (item = callbackList; item != NULL; item = item->hh.next)
+	{
+		ids[count++] = item->canID;
+	}
+	ret = SocketInput_SetFilter(socketInput, ids, count);
+	free(ids);
+
+	return (ret < 0) ? -1 : 0;
+}
+
+/* Dbc_SelectHandler_t */
+static void selectSignal(Dbc_Frame_t *frame, Dbc_Signal_t *signal, void *context)
+{
+	selection_t *selection = context;
+
+	add_callback(selection->callbackList, frame, signal, selection->callback, selection->reportMode, selection->deadband);
+
+	printf("-- %s (0x%03x) ", frame->name, frame->canID);
+	if (NULL != signal)
+		printf(" %s (%d [%d]) --", signal->name, signal->startBit, signal->signalLength);
+	printf("\n");
+}
+
+/**
+ * @brief      Subscribes to the frames or signals matching a selector
+ *
+ * @param[in]  database   The database
+ * @param      selector   Frame[.Signal], either part may be a glob pattern; modified
+ * @param      selection  The subscription
+ *
+ * @return     0 on success and -1 if nothing matches
+ */
+static int selectSignals(const Dbc_Database_t *database, char *selector, selection_t *selection)
+{
+	char *frameName = selector;
+	char *signalName = strchr(selector, '.');
+
+	printf("Trying to find: Frame: %s", frameName);
+	if (signalName != NULL)
+	{
+		*signalName = 0;
+		signalName++;
+		printf(", Signal: %s", signalName);
+	}
+	printf("\n");
+
+	if (0 == Dbc_Select(database, frameName, signalName, selectSignal, selection))
+	{
+		if (NULL == signalName || (!Dbc_IsPattern(frameName) && NULL == Dbc_FindFrameByName(database, frameName)))
+			fprintf(stderr, "[ERROR] Unable to find frame %s\n", frameName);
+		else
+			fprintf(stderr, "[ERROR] Unable to find signal %s\n", signalName);
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief      Subscribes to the selectors of a selection file
+ *
+ * The file has one selector per line. Blank lines and lines starting with #
+ * are ignored, "all" selects all frames.
+ *
+ * @param[in]  database     The database
+ * @param[in]  path         The selection file
+ * @param      selection    The subscription
+ * @param      process_all  Set if the file selects all frames
+ *
+ * @return     0 on success and -1 otherwise
+ */
+static int selectFromFile(const Dbc_Database_t *database, const char *path, selection_t *selection, int *process_all)
+{
+	FILE *fp;
+	char *line = NULL, *selector, *end;
+	size_t size = 0;
+	int ret = 0;
+
+	fp = fopen(path, "r");
+	if (NULL == fp)
+	{
+		fprintf(stderr, "[ERROR] Unable to open selection file %s: %s\n", path, strerror(errno));
+		return -1;
+	}
+
+	while (0 == ret && getline(&line, &size, fp) >= 0)
+	{
+		for (selector = line; isspace((unsigned char) *selector); selector++)
+			;
+		for (end = selector + strlen(selector); end > selector && isspace((unsigned char) end[-1]); end--)
+			;
+		*end = '\0';
+
+		if ('\0' == *selector || '#' == *selector)
+			continue;
+		if (strcmp(selector, "all") == 0)
+			*process_all = 1;
+		else
+			ret = selectSignals(database, selector, selection);
+	}
+
+	free(line);
+	fclose(fp);
+	return ret;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage:\n");
+	fprintf(stderr, "%s [options] Database [all]  # processes all frames\n", name);
+	fprintf(stderr, "%s [options] Database Message1.Signal1 [Message2.Signal2 Message3.Signal3]\n", name);
+	fprintf(stderr, "%s [options] Database 'Engine*.*Temp*' '*.WheelSpeed_?'  # glob patterns\n", name);
+	fprintf(stderr, "%s -w framelog|-t [options] [Database [selection]]  # converts frames\n", name);
+	fprintf(stderr, "Options:\n");
+	fprintf(stderr, "  -c           report signals only when their value changes\n");
+	fprintf(stderr, "  -d deadband  like -c, but ignore changes of the physical value below deadband\n");
+	fprintf(stderr, "  -u           skip frames with an unchanged payload, decode only signals whose bits changed\n");
+	fprintf(stderr, "  -r           print raw values only\n");
+	fprintf(stderr, "  -l selection read Message[.Signal] selectors (or patterns) from a file, one per line\n");
+	fprintf(stderr, "  -s           print statistics to stderr on exit\n");
+	fprintf(stderr, "  -f logfile   decode a candump -L log (optionally gzip or zstd compressed) or a frame log\n");
+	fprintf(stderr, "               file instead of stdin (may be repeated)\n");
+	fprintf(stderr, "  -j workers   threads decoding log files (default: number of CPUs);\n");
+	fprintf(stderr, "               -c, -d and -u keep state between frames and always use one\n");
+	fprintf(stderr, "  -w framelog  write the (selected) frames to a binary frame log instead of decoding them\n");
+	fprintf(stderr, "  -t           print the (selected) frames as candump -L text instead of decoding them\n");
+	fprintf(stderr, "  -i interface receive frames from a CAN interface (\"any\" for all) instead of stdin\n");
+	fprintf(stderr, "  -b cache     load the database from a binary cache file, which is (re)built\n");
+	fprintf(stderr, "               from the DBC whenever the DBC contents change\n");
+	fprintf(stderr, "  -p workers   decode stdin on a pipeline of reader, workers and writer threads,\n");
+	fprintf(stderr, "               so a slow output doesn't stall live input; -c, -d and -u use one worker\n");
+}
+
+int main(int argc, char **argv)
+{
+	decoder_t decoder;
+	int process_all = 0;
+	int opt;
+	const char *inputFiles[MAX_INPUT_FILES];
+	unsigned int inputFileCount = 0, i;
+	long workers = sysconf(_SC_NPROCESSORS_ONLN);
+	long pipelineWorkers = 0;
+	Pipeline_t pipeline;
+	const char *interface = NULL;
+	SocketInput_t socketInput;
+	struct sigaction action;
+	struct stat st;
+	IdFilter_t filter;
+	const char *frameLogPath = NULL;
+	const char *cachePath = NULL;
+	const char *selectionPath = NULL;
+	selection_t selection;
+	FrameLog_Writer_t frameLog;
+	int print_frames = 0;
+	signal_callback_list_t *callbackItem;
+	int print_stats = 0;
+	__u8 reportMode = REPORT_ALWAYS;
+	unsigned long framesSkipped, signalsSkipped;
+	callback_t callback = printCallback;
+	double deadband = 0.;
+	char *end;
+	LineReader_t reader;
+	char *line;
+	size_t length;
+	int ret;
+
+	Dbc_Database_t *database = NULL;
+	signal_callback_list_t *callbackList = NULL;
+
+	while ((opt = getopt(argc, argv, "cd:ursf:j:p:i:w:tb:l:")) != -1)
+	{
+		switch (opt)
+		{
+		case 'c':
+			reportMode |= REPORT_ON_CHANGE;
+			break;
+		case 'd':
+			reportMode |= REPORT_ON_CHANGE;
+			deadband = strtod(optarg, &end);
+			if (end == optarg || *end != '\0' || deadband < 0.)
+			{
+				fprintf(stderr, "[ERROR] Invalid deadband %s\n", optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'u':
+			reportMode |= REPORT_SKIP_UNCHANGED;
+			break;
+		case 'r':
+			callback = printRawCallback;
+			break;
+		case 's':
+			print_stats = 1;
+			break;
+		case 'f':
+			if (inputFileCount == MAX_INPUT_FILES)
+			{
+				fprintf(stderr, "[ERROR] Too many log files\n");
+				exit(EXIT_FAILURE);
+			}
+			inputFiles[inputFileCount++] = optarg;
+			break;
+		case 'j':
+			workers = strtol(optarg, &end, 10);
+			if (end == optarg || *end != '\0' || workers < 1)
+			{
+				fprintf(stderr, "[ERROR] Invalid number of workers %s\n", optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		case 'i':
+			interface = optarg;
+			break;
+		case 'w':
+			frameLogPath = optarg;
+			break;
+		case 't':
+			print_frames = 1;
+			break;
+		case 'b':
+			cachePath = optarg;
+			break;
+		case 'l':
+			selectionPath = optarg;
+			break;
+		case 'p':
+			pipelineWorkers = strtol(optarg, &end, 10);
+			if (end == optarg || *end != '\0' || pipelineWorkers < 1)
+			{
+				fprintf(stderr, "[ERROR] Invalid number of workers %s\n", optarg);
+				exit(EXIT_FAILURE);
+			}
+			break;
+		default:
+			usage(argv[0]);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	/* Converting frames doesn't need a database */
+	if (argc - optind < 1 && NULL == frameLogPath && !print_frames)
+	{
+		usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+	/* Let argv[1] point to the database */
+	argc -= optind - 1;
+	argv += optind - 1;
+
+	/* Read DBC */
+	if (argc >= 2)
+	{
+		ret = (NULL != cachePath) ? DbcCache_Init(&database, argv[1], cachePath) : Dbc_Init(&database, argv[1]);
+		if (ret)
+		{
+			fprintf(stderr, "[ERROR] Unable to open database %s\n", argv[1]);
+			exit(EXIT_FAILURE);
+		}
+		argc--;
+		argv++;
+	}
+
+	/* Decode all frames none were provided */
+	if (argc == 1 && NULL == selectionPath)
+	{
+		process_all = 1;
+	}
+
+	/* Parse arguments (frames/signals which should be decoded) */
+	selection.callbackList = &callbackList;
+	selection.callback = callback;
+	selection.reportMode = reportMode;
+	selection.deadband = deadband;
+	if (NULL != selectionPath && selectFromFile(database, selectionPath, &selection, &process_all))
+	{
+		exit(EXIT_FAILURE);
+	}
+	while (argc >= 2)
+	{
+		if (strcmp(argv[1], "all") == 0)
+		{
+			process_all = 1;
+			break;
+		}
+
+		if (selectSignals(database, argv[1], &selection))
+		{
+			exit(EXIT_FAILURE);
+		}
+		argc--;
+		argv++;
+	}
+
+	/* On change reporting needs per frame and signal state, which only subscriptions have */
+	if (process_all && reportMode != REPORT_ALWAYS)
+	{
+		for (i = 0; NULL != database && i < database->frameCount; i++)
+		{
+			add_callback(&callbackList, &database->frames[i], NULL, callback, reportMode, deadband);
+		}
+		process_all = 0;
+	}
+
+	output = stdout;
+	decoder.database = database;
+	decoder.callbackList = callbackList;
+	decoder.callback = callback;
+	decoder.process_all = process_all;
+	decoder.filter = NULL;
+	decoder.writer = NULL;
+	decoder.print_frames = print_frames;
+
+	if (NULL != frameLogPath)
+	{
+		if (FrameLog_Create(&frameLog, frameLogPath))
+		{
+			fprintf(stderr, "[ERROR] Unable to create frame log %s: %s\n", frameLogPath, strerror(errno));
+			exit(EXIT_FAILURE);
+		}
+		decoder.writer = &frameLog;
+
+		/* Records are appended in input order by a single thread */
+		workers = 1;
+		if (pipelineWorkers > 1)
+		{
+			pipelineWorkers = 1;
+		}
+	}
+
+	/* All mode reports unknown frames, otherwise only subscribed frames get past the ID */
+	IdFilter_Init(&filter);
+	if (!process_all)
+	{
+		for (callbackItem = callbackList; callbackItem != NULL; callbackItem = callbackItem->hh.next)
+		{
+			if (IdFilter_Add(&filter, callbackItem->canID))
+			{
+				fprintf(stderr, "[ERROR] Unable to allocate the ID filter\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		decoder.filter = &filter;
+	}
+
+	if (NULL != interface)
+	{
+		if (SocketInput_Open(&socketInput, interface))
+		{
+			fprintf(stderr, "[ERROR] Unable to open CAN interface %s: %s\n", interface, strerror(errno));
+			exit(EXIT_FAILURE);
+		}
+
+		/* Unselected frames shouldn't even reach user space */
+		if (!process_all && setSocketFilter(&socketInput, callbackList))
+		{
+			fprintf(stderr, "[ERROR] Unable to set the CAN filter: %s\n", strerror(errno));
+			exit(EXIT_FAILURE);
+		}
+
+		memset(&action, 0, sizeof(action));
+		action.sa_handler = interruptHandler;
+		sigaction(SIGINT, &action, NULL);
+		sigaction(SIGTERM, &action, NULL);
+
+		while ((ret = SocketInput_Receive(&socketInput, decodeSelectedFrame, &decoder)) > 0)
+		{
+			fflush(stdout);
+		}
+		if (ret < 0)
+		{
+			perror("[ERROR] Unable to receive frames");
+			exit(EXIT_FAILURE);
+		}
+		if (print_stats)
+		{
+			fprintf(stderr, "Frames received: %lu\n", socketInput.frames);
+			fprintf(stderr, "Frames dropped by the kernel: %u\n", socketInput.drops);
+			fprintf(stderr, "CAN filters installed: %u\n", socketInput.filters);
+		}
+		SocketInput_Close(&socketInput);
+	}
+	else if (inputFileCount > 0)
+	{
+		/* Per frame state requires the frames in order */
+		if (reportMode != REPORT_ALWAYS || workers < 1)
+		{
+			workers = 1;
+		}
+
+		/* Selection info printed above must come first */
+		fflush(stdout);
+		for (i = 0; i < inputFileCount; i++)
+		{
+			/* Streams can only be opened and read once, they are text logs */
+			if (0 == stat(inputFiles[i], &st) && !S_ISREG(st.st_mode))
+			{
+				ret = ChunkedInput_ProcessFile(inputFiles[i], 1, decodeChunk, &decoder, stdout);
+			}
+			else
+			{
+				ret = FrameLog_ProcessFile(inputFiles[i], decodeSelectedFrame, &decoder);
+			}
+			if (FRAME_LOG_NOT_A_LOG == ret)
+			{
+				ret = CompressedInput_ProcessFile(inputFiles[i], decodeChunk, &decoder, stdout);
+			}
+			if (COMPRESSED_INPUT_NONE == ret)
+			{
+				ret = ChunkedInput_ProcessFile(inputFiles[i], workers, decodeChunk, &decoder, stdout);
+			}
+			if (CHUNK_HANDLER_FAILED == ret)
+			{
+				fprintf(stderr, "[ERROR] Incorrect line format in logfile\n");
+				exit(EXIT_FAILURE);
+			}
+			if (ret)
+			{
+				fprintf(stderr, "[ERROR] Unable to read log file %s\n", inputFiles[i]);
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+	else if (pipelineWorkers > 0)
+	{
+		/* Per frame state requires the frames in order */
+		if (reportMode != REPORT_ALWAYS)
+		{
+			pipelineWorkers = 1;
+		}
+
+		fflush(stdout);
+		if (Pipeline_Init(&pipeline, pipelineWorkers, decodeChunk, &decoder, stdout))
+		{
+			fprintf(stderr, "[ERROR] Unable to start the decoding pipeline\n");
+			exit(EXIT_FAILURE);
+		}
+		ret = Pipeline_Run(&pipeline, STDIN_FILENO);
+		if (CHUNK_HANDLER_FAILED == ret)
+		{
+			fprintf(stderr, "[ERROR] Incorrect line format in logfile\n");
+			exit(EXIT_FAILURE);
+		}
+		if (ret)
+		{
+			perror("[ERROR] Unable to read input");
+			exit(EXIT_FAILURE);
+		}
+		if (print_stats)
+		{
+			Pipeline_PrintStatistics(&pipeline, stderr);
+		}
+		Pipeline_DeInit(&pipeline);
+	}
+	else
+	{
+		if (LineReader_Init(&reader, STDIN_FILENO, LINE_READER_BLOCK_SIZE))
+		{
+			fprintf(stderr, "[ERROR] Unable to allocate the input buffer\n");
+			exit(EXIT_FAILURE);
+		}
+
+		while ((ret = LineReader_Next(&reader, &line, &length)) > 0)
+		{
+			if (decodeLine(&decoder, line, length))
+			{
+				fprintf(stderr, "[ERROR] Incorrect line format in logfile\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		if (ret < 0)
+		{
+			perror("[ERROR] Unable to read input");
+			exit(EXIT_FAILURE);
+		}
+		LineReader_DeInit(&reader);
+	}
+
+	if (print_stats)
+	{
+		get_skip_statistics(callbackList, &framesSkipped, &signalsSkipped);
+		fprintf(stderr, "Unchanged frames skipped: %lu\n", framesSkipped);
+		fprintf(stderr, "Unchanged signals skipped: %lu\n", signalsSkipped);
+	}
+
+	if (NULL != frameLogPath)
+	{
+		if (FrameLog_Close(&frameLog))
+		{
+			fprintf(stderr, "[ERROR] Unable to write frame log %s: %s\n", frameLogPath, strerror(errno));
+			exit(EXIT_FAILURE);
+		}
+		if (print_stats)
+		{
+			fprintf(stderr, "Frames written: %lu\n", frameLog.frames);
+		}
+	}
+
+	IdFilter_DeInit(&filter);
+	Dbc_DeInit(database);
+	delete_callbacks(callbackList);
+	return 0;
+}
@@ -0,0 +1,247 @@
+/**
+ * @file parseLine.c
+ *
+ * Parse candump -L log lines
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <string.h>
+#include "parseLine.h"
+
+/**
+Section: Definitions
+*/
+
+#define NSEC_PER_SEC      1000000000ULL
+#define MAX_SEC_DIGITS    10  /* seconds must not overflow the nanosecond timestamp */
+#define MAX_FRAC_DIGITS   9
+#define SFF_ID_DIGITS     3
+#define EFF_ID_DIGITS     8
+
+/**
+Section: Private data
+*/
+
+/* Value of an ASCII hex digit, -1 for anything else */
+static const signed char hexValue[256] =
+{
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+};
+
+/* Valid CAN FD payload length for 9..64 bytes of data */
+static const unsigned char fdLength[CANFD_MAX_DLEN + 1] =
+{
+	 0,  1,  2,  3,  4,  5,  6,  7,  8, 12, 12, 12, 12, 16, 16, 16,
+	16, 20, 20, 20, 20, 24, 24, 24, 24, 32, 32, 32, 32, 32, 32, 32,
+	32, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48, 48,
+	48, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64, 64,
+	64,
+};
+
+/**
+Section: Private functions
+*/
+
+/**
+ * @brief      Converts the timestamp "sec.frac" between the parentheses of a line
+ *
+ * @param[in]  p          First digit
+ * @param[in]  end        The closing parenthesis
+ * @param[out] timestamp  Timestamp in nanoseconds
+ *
+ * @return     0 on success and a negative value otherwise
+ */
+static int parseTimestamp(const char *p, const char *end, __u64 *timestamp)
+{
+	__u64 sec = 0, nsec = 0;
+	unsigned int digits;
+
+	for (digits = 0; p < end && *p >= '0' && *p <= '9'; p++, digits++)
+	{
+		sec = sec * 10 + (*p - '0');
+	}
+	if (0 == digits || digits > MAX_SEC_DIGITS || p == end || '.' != *p++)
+	{
+		return -1;
+	}
+	for (digits = 0; p < end && *p >= '0' && *p <= '9'; p++, digits++)
+	{
+		if (digits < MAX_FRAC_DIGITS)
+		{
+			nsec = nsec * 10 + (*p - '0');
+		}
+	}
+	if (0 == digits || p != end)
+	{
+		return -1;
+	}
+	for (; digits < MAX_FRAC_DIGITS; digits++)
+	{
+		nsec *= 10;
+	}
+	*timestamp = sec * NSEC_PER_SEC + nsec;
+
+	return 0;
+}
+
+/**
+Section: Implementation
+*/
+
+int parseLine(const char *line, size_t length, const IdFilter_t *filter, __u64 *timestamp, const char **device, size_t *deviceLength, struct canfd_frame *cf)
+{
+	const char *p = line;
+	const char *end = line + length;
+	const char *timestampStart, *timestampEnd;
+	canid_t canID = 0;
+	unsigned int digits, maxLength = CAN_MAX_DLEN;
+	int high, low;
+
+	/* Ignore the line end */
+	while (end > p && ('\n' == end[-1] || '\r' == end[-1]))
+	{
+		end--;
+	}
+
+	/* Timestamp, converted once the frame is known to be wanted */
+	if (p == end || '(' != *p++)
+	{
+		return -1;
+	}
+	timestampStart = p;
+	timestampEnd = memchr(p, ')', end - p);
+	if (NULL == timestampEnd)
+	{
+		return -1;
+	}
+	p = timestampEnd + 1;
+
+	/* Device */
+	if (p == end || ' ' != *p)
+	{
+		return -1;
+	}
+	while (p < end && ' ' == *p)
+	{
+		p++;
+	}
+	*device = p;
+	while (p < end && ' ' != *p)
+	{
+		p++;
+	}
+	if (p == end || p == *device)
+	{
+		return -1;
+	}
+	*deviceLength = p - *device;
+	while (p < end && ' ' == *p)
+	{
+		p++;
+	}
+
+	/* CAN ID */
+	for (digits = 0; p < end && hexValue[(unsigned char) *p] >= 0; p++, digits++)
+	{
+		canID = (canID << 4) | hexValue[(unsigned char) *p];
+	}
+	if (p == end || '#' != *p++)
+	{
+		return -1;
+	}
+	if (EFF_ID_DIGITS == digits)
+	{
+		/* 8 digits but no error frame? then it is an extended frame */
+		if (!(canID & CAN_ERR_FLAG))
+		{
+			canID |= CAN_EFF_FLAG;
+		}
+	}
+	else if (SFF_ID_DIGITS != digits)
+	{
+		return -1;
+	}
+	/* RTR frame "id#R", the filter has to see the flag */
+	if (p < end && ('R' == *p || 'r' == *p))
+	{
+		canID |= CAN_RTR_FLAG;
+	}
+
+	if (NULL != filter && !IdFilter_Contains(filter, canID))
+	{
+		cf->can_id = canID;
+		return PARSE_LINE_REJECTED;
+	}
+	if (parseTimestamp(timestampStart, timestampEnd, timestamp))
+	{
+		return -1;
+	}
+
+	memset(cf, 0, sizeof(*cf));
+	cf->can_id = canID;
+
+	/* CAN FD frame: "id##<flags><data>" */
+	if (p < end && '#' == *p)
+	{
+		p++;
+		if (p == end || hexValue[(unsigned char) *p] < 0)
+		{
+			return -1;
+		}
+		cf->flags = hexValue[(unsigned char) *p++] | CANFD_FDF;
+		maxLength = CANFD_MAX_DLEN;
+	}
+	/* RTR frame */
+	else if (canID & CAN_RTR_FLAG)
+	{
+		return 0;
+	}
+
+	/* Data, optionally separated by '.', anything behind a blank is ignored */
+	while (p < end && ' ' != *p && '\t' != *p)
+	{
+		if ('.' == *p)
+		{
+			p++;
+			continue;
+		}
+		if (end - p < 2 || maxLength == cf->len)
+		{
+			return -1;
+		}
+		high = hexValue[(unsigned char) p[0]];
+		low = hexValue[(unsigned char) p[1]];
+		if ((high | low) < 0)
+		{
+			return -1;
+		}
+		cf->data[cf->len++] = (high << 4) | low;
+		p += 2;
+	}
+
+	/* Like candump, pad CAN FD payloads to the next valid length */
+	if (cf->len > CAN_MAX_DLEN)
+	{
+		cf->len = fdLength[cf->len];
+	}
+
+	return 0;
+}
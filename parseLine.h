@@ -0,0 +1,49 @@
+/**
+ * @file parseLine.h
+ *
+ * Parse candump -L log lines
+ */
+
+#ifndef _PARSELINE_H_
+#define _PARSELINE_H_
+
+#include <stddef.h>
+#include <linux/can.h>
+#include "idFilter.h"
+
+/**
+Section: Definitions
+*/
+
+#define PARSE_LINE_REJECTED 1  /**< The ID of the frame is not in the filter */
+
+#ifndef CANFD_FDF
+#define CANFD_FDF 0x04  /* Missing in older kernel headers */
+#endif
+
+/**
+ * @brief      Parses one candump -L line: "(sec.frac) device id#data"
+ *
+ * The line is parsed in a single pass without being modified, so it may
+ * live in a read-only mapping. The device name is returned as a view into
+ * the line. The frame may be classic (3 digit ID), extended or error (8 digit
+ * ID), RTR ("id#R") or CAN FD ("id##<flags><data>"), data bytes may be
+ * separated by '.'. CAN FD frames have CANFD_FDF set in flags.
+ *
+ * The filter is consulted right after the ID was read. Rejected frames don't
+ * get their timestamp and payload converted, or checked for errors; only
+ * the device and the ID of cf are set.
+ *
+ * @param[in]  line          The line, doesn't need to be NUL terminated
+ * @param[in]  length        Length of the line, a trailing line end is ignored
+ * @param[in]  filter        The accepted IDs, NULL accepts all frames
+ * @param[out] timestamp     Timestamp in nanoseconds
+ * @param[out] device        Device name, points into line (not NUL terminated)
+ * @param[out] deviceLength  Length of the device name
+ * @param[out] cf            The frame, data bytes behind len are zeroed
+ *
+ * @return     0 on success, PARSE_LINE_REJECTED if the ID was rejected and a negative value otherwise
+ */
+int parseLine(const char *line, size_t length, const IdFilter_t *filter, __u64 *timestamp, const char **device, size_t *deviceLength, struct canfd_frame *cf);
+
+#endif
@@ -0,0 +1,330 @@
+/**
+ * @file pipeline.c
+ *
+ * Threaded reader -> decoder -> writer pipeline for live input
+ */
+
+/**
+Section: Included Files
+*/
+
+#define _GNU_SOURCE  /* memrchr() */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "pipeline.h"
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	char *data;
+	size_t length;
+	char *output;
+	size_t outputLength;
+	int failed;
+} PipelineBatch_t;
+
+/**
+Section: Private functions
+*/
+
+static PipelineBatch_t *Pipeline_NewBatch(size_t size)
+{
+	PipelineBatch_t *batch = calloc(1, sizeof(PipelineBatch_t));
+
+	if (NULL == batch)
+	{
+		return NULL;
+	}
+	batch->data = malloc(size);
+	if (NULL == batch->data)
+	{
+		free(batch);
+		return NULL;
+	}
+
+	return batch;
+}
+
+static void Pipeline_FreeBatch(PipelineBatch_t *batch)
+{
+	free(batch->data);
+	free(batch->output);
+	free(batch);
+}
+
+static void *Pipeline_Worker(void *arg)
+{
+	PipelineWorker_t *worker = arg;
+	Pipeline_t *pipeline = worker->pipeline;
+	PipelineBatch_t *batch;
+	FILE *stream;
+
+	/* A NULL batch ends the input, pass it on to the writer */
+	while (NULL != (batch = SpscRing_PopWait(&pipeline->input[worker->index])))
+	{
+		/* Batches behind a failed one are dropped by the writer, don't decode them */
+		if (!atomic_load_explicit(&pipeline->stopped, memory_order_relaxed))
+		{
+			stream = open_memstream(&batch->output, &batch->outputLength);
+			if (NULL == stream)
+			{
+				pipeline->failed = 1;
+			}
+			else
+			{
+				batch->failed = (0 != pipeline->handler(batch->data, batch->length, stream, pipeline->context));
+				fclose(stream);
+			}
+		}
+		free(batch->data);
+		batch->data = NULL;
+
+		SpscRing_PushWait(&pipeline->output[worker->index], batch);
+	}
+	SpscRing_PushWait(&pipeline->output[worker->index], NULL);
+
+	return NULL;
+}
+
+static void *Pipeline_Writer(void *arg)
+{
+	Pipeline_t *pipeline = arg;
+	PipelineBatch_t *batch;
+	unsigned int next = 0;
+	void *item;
+
+	for (;;)
+	{
+		/* Don't hold back decoded output while waiting for more input */
+		if (SpscRing_Pop(&pipeline->output[next], &item))
+		{
+			fflush(pipeline->stream);
+			item = SpscRing_PopWait(&pipeline->output[next]);
+		}
+		batch = item;
+		if (NULL == batch)
+		{
+			break;
+		}
+
+		if (NULL != batch->output && !atomic_load_explicit(&pipeline->stopped, memory_order_relaxed))
+		{
+			fwrite(batch->output, 1, batch->outputLength, pipeline->stream);
+		}
+		if (batch->failed)
+		{
+			atomic_store_explicit(&pipeline->stopped, 1, memory_order_relaxed);
+		}
+		Pipeline_FreeBatch(batch);
+		next = (next + 1) % pipeline->workerCount;
+	}
+	fflush(pipeline->stream);
+
+	return NULL;
+}
+
+/**
+ * @brief      Ends the input of the first count workers and waits for them
+ */
+static void Pipeline_Stop(Pipeline_t *pipeline, unsigned int count)
+{
+	unsigned int i;
+
+	for (i = 0; i < count; i++)
+	{
+		SpscRing_PushWait(&pipeline->input[i], NULL);
+	}
+	for (i = 0; i < count; i++)
+	{
+		pthread_join(pipeline->workers[i].thread, NULL);
+	}
+}
+
+/**
+ * @brief      Hands a batch to the next worker
+ */
+static void Pipeline_Submit(Pipeline_t *pipeline, PipelineBatch_t *batch)
+{
+	SpscRing_PushWait(&pipeline->input[pipeline->batches % pipeline->workerCount], batch);
+	pipeline->batches++;
+}
+
+/**
+Section: Implementation
+*/
+
+int Pipeline_Init(Pipeline_t *pipeline, unsigned int workers, ChunkHandler_t handler, void *context, FILE *stream)
+{
+	unsigned int i;
+
+	memset(pipeline, 0, sizeof(Pipeline_t));
+	atomic_init(&pipeline->stopped, 0);
+	if (workers < 1)
+	{
+		workers = 1;
+	}
+	pipeline->workerCount = workers;
+	pipeline->handler = handler;
+	pipeline->context = context;
+	pipeline->stream = stream;
+
+	pipeline->workers = calloc(workers, sizeof(PipelineWorker_t));
+	pipeline->input = calloc(workers, sizeof(SpscRing_t));
+	pipeline->output = calloc(workers, sizeof(SpscRing_t));
+	if (NULL == pipeline->workers || NULL == pipeline->input || NULL == pipeline->output)
+	{
+		Pipeline_DeInit(pipeline);
+		return -1;
+	}
+
+	for (i = 0; i < workers; i++)
+	{
+		if (SpscRing_Init(&pipeline->input[i], PIPELINE_RING_SIZE) || SpscRing_Init(&pipeline->output[i], PIPELINE_RING_SIZE))
+		{
+			Pipeline_DeInit(pipeline);
+			return -1;
+		}
+	}
+
+	for (i = 0; i < workers; i++)
+	{
+		pipeline->workers[i].pipeline = pipeline;
+		pipeline->workers[i].index = i;
+		if (pthread_create(&pipeline->workers[i].thread, NULL, Pipeline_Worker, &pipeline->workers[i]))
+		{
+			Pipeline_Stop(pipeline, i);
+			Pipeline_DeInit(pipeline);
+			return -1;
+		}
+	}
+	if (pthread_create(&pipeline->writer, NULL, Pipeline_Writer, pipeline))
+	{
+		Pipeline_Stop(pipeline, workers);
+		Pipeline_DeInit(pipeline);
+		return -1;
+	}
+
+	return 0;
+}
+
+int Pipeline_Run(Pipeline_t *pipeline, int fd)
+{
+	PipelineBatch_t *batch, *next;
+	size_t size = PIPELINE_BATCH_SIZE;
+	const char *newline;
+	char *data;
+	ssize_t n;
+	int ret = 0;
+
+	batch = Pipeline_NewBatch(size);
+	while (NULL != batch && !atomic_load_explicit(&pipeline->stopped, memory_order_relaxed))
+	{
+		n = read(fd, batch->data + batch->length, size - batch->length);
+		if (n < 0)
+		{
+			if (EINTR == errno)
+			{
+				continue;
+			}
+			ret = -1;
+			break;
+		}
+		if (0 == n)
+		{
+			/* The last line doesn't need a line end */
+			break;
+		}
+		batch->length += n;
+
+		newline = memrchr(batch->data, '\n', batch->length);
+		if (NULL == newline)
+		{
+			/* Wait for the rest of the line, grow the batch if it doesn't fit */
+			if (batch->length == size)
+			{
+				data = realloc(batch->data, size * 2);
+				if (NULL == data)
+				{
+					Pipeline_FreeBatch(batch);
+					batch = NULL;
+					break;
+				}
+				batch->data = data;
+				size *= 2;
+			}
+			continue;
+		}
+
+		/* Carry the incomplete line over to the next batch */
+		next = Pipeline_NewBatch(size);
+		if (NULL == next)
+		{
+			break;
+		}
+		next->length = batch->length - (newline + 1 - batch->data);
+		memcpy(next->data, newline + 1, next->length);
+		batch->length -= next->length;
+
+		Pipeline_Submit(pipeline, batch);
+		batch = next;
+	}
+
+	if (NULL == batch)
+	{
+		ret = -1;
+	}
+	else if (batch->length > 0)
+	{
+		Pipeline_Submit(pipeline, batch);
+	}
+	else
+	{
+		Pipeline_FreeBatch(batch);
+	}
+
+	Pipeline_Stop(pipeline, pipeline->workerCount);
+	pthread_join(pipeline->writer, NULL);
+
+	if (atomic_load_explicit(&pipeline->stopped, memory_order_relaxed))
+	{
+		return CHUNK_HANDLER_FAILED;
+	}
+	return (ret || pipeline->failed) ? -1 : 0;
+}
+
+void Pipeline_PrintStatistics(const Pipeline_t *pipeline, FILE *stream)
+{
+	unsigned int i;
+
+	fprintf(stream, "Pipeline batches: %lu\n", pipeline->batches);
+	for (i = 0; i < pipeline->workerCount; i++)
+	{
+		fprintf(stream, "Worker %u input ring: max depth %zu, overflows %lu\n", i, pipeline->input[i].maxDepth, pipeline->input[i].overflows);
+		fprintf(stream, "Worker %u output ring: max depth %zu, overflows %lu\n", i, pipeline->output[i].maxDepth, pipeline->output[i].overflows);
+	}
+}
+
+void Pipeline_DeInit(Pipeline_t *pipeline)
+{
+	unsigned int i;
+
+	for (i = 0; NULL != pipeline->input && i < pipeline->workerCount; i++)
+	{
+		SpscRing_DeInit(&pipeline->input[i]);
+	}
+	for (i = 0; NULL != pipeline->output && i < pipeline->workerCount; i++)
+	{
+		SpscRing_DeInit(&pipeline->output[i]);
+	}
+	free(pipeline->input);
+	free(pipeline->output);
+	free(pipeline->workers);
+	pipeline->input = NULL;
+	pipeline->output = NULL;
+	pipeline->workers = NULL;
+}
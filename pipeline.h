@@ -0,0 +1,101 @@
+/**
+ * @file pipeline.h
+ *
+ * Threaded reader -> decoder -> writer pipeline for live input
+ */
+
+#ifndef _PIPELINE_H_
+#define _PIPELINE_H_
+
+#include <stdio.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "spscRing.h"
+#include "chunkedInput.h"
+
+/**
+Section: Definitions
+*/
+
+#define PIPELINE_BATCH_SIZE  (64 << 10)  /**< Input read per batch */
+#define PIPELINE_RING_SIZE   64          /**< Batches queued per ring */
+
+/**
+Section: Public Types
+*/
+
+typedef struct Pipeline Pipeline_t;
+
+typedef struct
+{
+	Pipeline_t *pipeline;
+	unsigned int index;
+	pthread_t thread;
+} PipelineWorker_t;
+
+struct Pipeline
+{
+	unsigned int workerCount;
+	PipelineWorker_t *workers;
+	SpscRing_t *input;   /**< Reader to worker, one per worker */
+	SpscRing_t *output;  /**< Worker to writer, one per worker */
+	pthread_t writer;
+
+	ChunkHandler_t handler;
+	void *context;
+	FILE *stream;
+
+	unsigned long batches;
+	int failed;
+	atomic_int stopped;  /**< A handler failed, nothing behind its batch is decoded or written */
+};
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Allocates the rings and starts the worker and writer threads
+ *
+ * Batches of whole lines are dealt to the workers round robin and collected
+ * by the writer in the same order, so the output keeps the input order.
+ *
+ * @param      pipeline  The pipeline
+ * @param[in]  workers   Number of decoding threads
+ * @param[in]  handler   Decodes one batch, called on the worker threads
+ * @param      context   Passed to handler
+ * @param      stream    Where the decoded batches are written to
+ *
+ * @return     0 on success and a negative value otherwise
+ */
+int Pipeline_Init(Pipeline_t *pipeline, unsigned int workers, ChunkHandler_t handler, void *context, FILE *stream);
+
+/**
+ * @brief      Reads a file descriptor until end of input on the calling thread and waits for the output
+ *
+ * @param      pipeline  The pipeline
+ * @param[in]  fd        The file descriptor
+ *
+ * The input stops at the first batch the handler fails on.
+ *
+ * @return     0 on success, CHUNK_HANDLER_FAILED if the handler failed and a negative value on read errors
+ */
+int Pipeline_Run(Pipeline_t *pipeline, int fd);
+
+/**
+ * @brief      Prints the queue depth and overflow counters of all rings
+ *
+ * @param[in]  pipeline  The pipeline
+ * @param      stream    The stream
+ */
+void Pipeline_PrintStatistics(const Pipeline_t *pipeline, FILE *stream);
+
+/**
+ * @brief      Frees the rings of a pipeline after Pipeline_Run()
+ *
+ * @param      pipeline  The pipeline
+ */
+void Pipeline_DeInit(Pipeline_t *pipeline);
+
+#endif
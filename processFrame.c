@@ -1,199 +1,419 @@
-/**
- * @file processFrame.c
- *
- * Process Messages and Signals
- */
-
-/**
-Section: Included Files
-*/
-
-#include <stdio.h>
-#include <stdlib.h>
-#include "processFrame.h"
-#include "stdbool.h"
-#include "libcan-encode-decode/include/can_encode_decode_inl.h"
-
-float toPhysicalValue(uint64_t target, float factor, float offset, bool is_signed);
-uint64_t extractSignal(const uint8_t* frame, const uint8_t startbit, const uint8_t length, bool is_big_endian, bool is_signed);
-
-void add_callback(signal_callback_list_t **callbackList, Dbc_Frame_t *frame, Dbc_Signal_t *signal, callback_t callback, __u8 onChange)
-{
-	signal_callback_list_t *callbackItem;
-
-	callbackItem = malloc(sizeof(signal_callback_list_t));
-	callbackItem->frame = frame;
-	callbackItem->signal = signal;
-	callbackItem->callback = callback;
-	callbackItem->rawValue = 0;
-	callbackItem->onChange = onChange;
-
-	HASH_ADD_INT(*callbackList, signal, callbackItem);
-}
-
-void delete_callbacks(signal_callback_list_t *callbackList)
-{
-	signal_callback_list_t *callback, *callback_tmp;
-
-	HASH_ITER(hh, callbackList, callback, callback_tmp)
-	{
-		HASH_DEL(callbackList, callback);
-		free(callback);
-	}
-}
-
-void processAllFrames(Dbc_Frame_t *frames, callback_t callback, struct can_frame *cf, struct timeval tv, char *device)
-{
-	Dbc_Frame_t *frame;
-	Dbc_Signal_t *signal;
-	__u64 value = 0;
-	double scaled = 0.;
-	unsigned int muxerVal = 0;
-	const char *stringVal = NULL;
-	int frame_found = 0;
-
-	for (frame = frames; frame != NULL; frame = frame->hh.next)
-	{
-		/* Matching CAN frame */
-		if (frame->canID == cf->can_id)
-		{
-			frame_found = 1;
-
-			if (frame->isMultiplexed)
-			{
-				/* Find multiplexer */
-				for (signal = frame->signals; signal != NULL; signal = signal->hh.next)
-				{
-					if (DBC_MUX_DEFINE == signal->isMultiplexer)
-					{
-						muxerVal = extractSignal(cf->data, signal->startBit, signal->signalLength, (bool) signal->is_big_endian, signal->is_signed);
-						scaled = toPhysicalValue(muxerVal, signal->factor, signal->offset, signal->is_signed);
-						stringVal = Dbc_FindValueString(signal, muxerVal);
-						callback(frame->name, signal->name, muxerVal, stringVal, scaled, tv, device);
-						break;
-					}
-				}
-
-				for (signal = frame->signals; signal != NULL; signal = signal->hh.next)
-				{
-					/* decode not multiplexed signals and signals with correct muxVal */
-					if (DBC_MUX_NONE == signal->isMultiplexer || (DBC_MUX_DATA == signal->isMultiplexer && signal->muxId == muxerVal))
-					{
-						value = extractSignal(cf->data, signal->startBit, signal->signalLength, (bool) signal->is_big_endian, signal->is_signed);
-						scaled = toPhysicalValue(value, signal->factor, signal->offset, signal->is_signed);
-						stringVal = Dbc_FindValueString(signal, value);
-						callback(frame->name, signal->name, value, stringVal, scaled, tv, device);
-					}
-				}
-			}
-			else
-			{
-				for (signal = frame->signals; signal != NULL; signal = signal->hh.next)
-				{
-					value = extractSignal(cf->data, signal->startBit, signal->signalLength, (bool) signal->is_big_endian, signal->is_signed);
-					scaled = toPhysicalValue(value, signal->factor, signal->offset, signal->is_signed);
-					stringVal = Dbc_FindValueString(signal, value);
-					callback(frame->name, signal->name, value, stringVal, scaled, tv, device);
-				}
-			}
-		}
-	}
-
-	if (!frame_found)
-	{
-		value = cf->can_id;  /* place frame ID in actual value (dirty hack) */
-		callback(NULL, NULL, value, NULL, scaled, tv, device);
-	}
-}
-
-void processFrame(signal_callback_list_t *callbackList, struct can_frame *cf, struct timeval tv, char *device)
-{
-	signal_callback_list_t *callbackItem;
-	Dbc_Signal_t *signal;
-	__u64 value = 0;
-	double scaled = 0.;
-	const char *stringVal = NULL;
-	unsigned int muxerVal = 0;
-
-	/* Iterate through all callback elements */
-	for (callbackItem = callbackList; callbackItem != NULL; callbackItem = callbackItem->hh.next)
-	{
-		/* Matching CAN frame */
-		if (callbackItem->frame->canID == cf->can_id)
-		{
-			if (callbackItem->frame->isMultiplexed)
-			{
-				/* Find multiplexer */
-				for (signal = callbackItem->frame->signals; signal != NULL; signal = signal->hh.next)
-				{
-					if (DBC_MUX_DEFINE == signal->isMultiplexer)
-					{
-						muxerVal = extractSignal(cf->data, signal->startBit, signal->signalLength, (bool) signal->is_big_endian, signal->is_signed);
-						scaled = toPhysicalValue(muxerVal, signal->factor, signal->offset, signal->is_signed);
-						stringVal = Dbc_FindValueString(signal, muxerVal);
-						(callbackItem->callback)(callbackItem->frame->name, signal->name, muxerVal, stringVal, scaled, tv, device);
-						break;
-					}
-				}
-			}
-
-			if (callbackItem->signal == NULL)
-			{
-				/* Process all signals in message */
-
-				if (callbackItem->frame->isMultiplexed)
-				{
-					for (signal = callbackItem->frame->signals; signal != NULL; signal = signal->hh.next)
-					{
-						/* decode not multiplexed signals and signals with correct muxVal */
-						if (DBC_MUX_NONE == signal->isMultiplexer || (DBC_MUX_DATA == signal->isMultiplexer && signal->muxId == muxerVal))
-						{
-							value = extractSignal(cf->data, signal->startBit, signal->signalLength, (bool) signal->is_big_endian, signal->is_signed);
-							scaled = toPhysicalValue(value, signal->factor, signal->offset, signal->is_signed);
-							stringVal = Dbc_FindValueString(signal, value);
-							(callbackItem->callback)(callbackItem->frame->name, signal->name, value, stringVal, scaled, tv, device);
-						}
-					}
-
-				}
-				else
-				{
-					for (signal = callbackItem->frame->signals; signal != NULL; signal = signal->hh.next)
-					{
-						value = extractSignal(cf->data, signal->startBit, signal->signalLength, (bool) signal->is_big_endian, signal->is_signed);
-						scaled = toPhysicalValue(value, signal->factor, signal->offset, signal->is_signed);
-						stringVal = Dbc_FindValueString(signal, value);
-						(callbackItem->callback)(callbackItem->frame->name, signal->name, value, stringVal, scaled, tv, device);
-					}
-				}
-			}
-			else
-			{
-				if (callbackItem->frame->isMultiplexed)
-				{
-					if (DBC_MUX_NONE == callbackItem->signal->isMultiplexer || (DBC_MUX_DATA == callbackItem->signal->isMultiplexer && callbackItem->signal->muxId == muxerVal))
-					{
-						value = extractSignal(cf->data, callbackItem->signal->startBit, callbackItem->signal->signalLength, (bool) callbackItem->signal->is_big_endian,
-								callbackItem->signal->is_signed);
-						scaled = toPhysicalValue(value, callbackItem->signal->factor, callbackItem->signal->offset, callbackItem->signal->is_signed);
-						stringVal = Dbc_FindValueString(callbackItem->signal, value);
-						callbackItem->rawValue = value;
-						(callbackItem->callback)(callbackItem->frame->name, callbackItem->signal->name, value, stringVal, scaled, tv, device);
-					}
-				}
-				else
-				{
-					if ((0 == callbackItem->onChange) || (callbackItem->rawValue != value))
-					{
-						value = extractSignal(cf->data, callbackItem->signal->startBit, callbackItem->signal->signalLength, (bool) callbackItem->signal->is_big_endian,
-								callbackItem->signal->is_signed);
-						scaled = toPhysicalValue(value, callbackItem->signal->factor, callbackItem->signal->offset, callbackItem->signal->is_signed);
-						stringVal = Dbc_FindValueString(callbackItem->signal, value);
-						callbackItem->rawValue = value;
-						(callbackItem->callback)(callbackItem->frame->name, callbackItem->signal->name, value, stringVal, scaled, tv, device);
-					}
-				}
-			}
-		}
-	}
-}
+/**
+ * @file processFrame.c
+ *
+ * Process Messages and Signals
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "processFrame.h"
+#include "stdbool.h"
+
+/**
+Section: Private functions
+*/
+
+/**
+ * @brief      Checks whether any bit of a signal differs from the last frame
+ *
+ * @param[in]  step   The decode step
+ * @param[in]  delta  XOR of the current and the last payload, NULL if unknown
+ *
+ * @return     true if the signal may have changed
+ */
+static inline bool stepChanged(const Dbc_DecodeStep_t *step, const __u8 *delta)
+{
+	/* Extracting bits commutes with XOR, so the bits of the delta are the changed bits */
+	return NULL == delta || 0 != extractBits(step, delta);
+}
+
+/**
+ * @brief      Converts a raw value into its physical value
+ *
+ * @param[in]  step  The decode step
+ * @param[in]  raw   The raw value returned by decodeRaw()
+ *
+ * @return     The physical value
+ */
+static inline double decodePhysical(const Dbc_DecodeStep_t *step, __u64 raw)
+{
+	switch (DBC_STEP_SCALE(step->flags))
+	{
+	case DBC_SCALE_IDENTITY:
+		return (step->flags & DBC_STEP_SIGNED) ? (double) (__s64) raw : (double) raw;
+	case DBC_SCALE_INTEGER:
+		/* Unsigned raw values fit into 62 bits here (see Dbc_ClassifyScale) */
+		return (double) ((__s64) raw * (__s64) step->factor + (__s64) step->offset);
+	default:
+		if (step->flags & DBC_STEP_SIGNED)
+		{
+			return (__s64) raw * step->factor + step->offset;
+		}
+		return raw * step->factor + step->offset;
+	}
+}
+
+/**
+Section: Implementation
+*/
+
+static void add_signal_callback(signal_callback_list_t *callbackItem, const Dbc_DecodeStep_t *step, callback_t callback, __u8 onChange, double deadband)
+{
+	signal_callback_t *signalCallback;
+	unsigned int i;
+
+	/* Keep the callbacks in plan order; every signal is reported only once per frame */
+	for (i = 0; i < callbackItem->callbackCount; i++)
+	{
+		if (callbackItem->callbacks[i].step == step)
+		{
+			return;
+		}
+		if (callbackItem->callbacks[i].step > step)
+		{
+			break;
+		}
+	}
+
+	if (callbackItem->callbackCount == callbackItem->callbackSize)
+	{
+		callbackItem->callbackSize = callbackItem->callbackSize ? callbackItem->callbackSize * 2 : 8;
+		callbackItem->callbacks = realloc(callbackItem->callbacks, callbackItem->callbackSize * sizeof(signal_callback_t));
+		callbackItem->lastValues = realloc(callbackItem->lastValues, callbackItem->callbackSize * sizeof(signal_last_value_t));
+	}
+
+	signalCallback = &callbackItem->callbacks[i];
+	memmove(signalCallback + 1, signalCallback, (callbackItem->callbackCount - i) * sizeof(signal_callback_t));
+	memmove(&callbackItem->lastValues[i + 1], &callbackItem->lastValues[i], (callbackItem->callbackCount - i) * sizeof(signal_last_value_t));
+	callbackItem->callbackCount++;
+
+	signalCallback->step = step;
+	signalCallback->callback = callback;
+	signalCallback->onChange = onChange;
+	signalCallback->deadband = deadband;
+	callbackItem->lastValues[i].valid = 0;
+}
+
+static void update_mux_index(signal_callback_list_t *callbackItem)
+{
+	Dbc_Frame_t *frame = callbackItem->frame;
+	const Dbc_DecodeStep_t *step;
+	unsigned int i;
+
+	/* Callbacks follow the plan order: static steps first, then the multiplexer pages */
+	for (i = 0; i < callbackItem->callbackCount; i++)
+	{
+		if (callbackItem->callbacks[i].step->flags & DBC_STEP_MULTIPLEXED)
+		{
+			break;
+		}
+	}
+	callbackItem->staticCount = i;
+
+	if (0 == frame->muxPageCount)
+	{
+		return;
+	}
+
+	if (NULL == callbackItem->muxPages)
+	{
+		callbackItem->muxPages = malloc(frame->muxPageCount * sizeof(Dbc_MuxPage_t));
+	}
+	memset(callbackItem->muxPages, 0, frame->muxPageCount * sizeof(Dbc_MuxPage_t));
+
+	for (; i < callbackItem->callbackCount; i++)
+	{
+		step = callbackItem->callbacks[i].step;
+		if (0 == callbackItem->muxPages[step->muxId].count)
+		{
+			callbackItem->muxPages[step->muxId].first = i;
+		}
+		callbackItem->muxPages[step->muxId].count++;
+	}
+}
+
+void add_callback(signal_callback_list_t **callbackList, Dbc_Frame_t *frame, Dbc_Signal_t *signal, callback_t callback, __u8 reportMode, double deadband)
+{
+	signal_callback_list_t *callbackItem;
+	const Dbc_DecodeStep_t *step = NULL;
+	unsigned int i;
+	__u8 onChange = (reportMode & REPORT_ON_CHANGE) ? 1 : 0;
+
+	if (NULL != signal)
+	{
+		step = Dbc_FindDecodeStep(frame, signal);
+		if (NULL == step)
+		{
+			/* Signal can't be decoded (already reported by Dbc_Init) */
+			return;
+		}
+	}
+
+	HASH_FIND_INT(*callbackList, &frame->canID, callbackItem);
+	if (NULL == callbackItem)
+	{
+		callbackItem = malloc(sizeof(signal_callback_list_t));
+		callbackItem->canID = frame->canID;
+		callbackItem->frame = frame;
+		callbackItem->callbacks = NULL;
+		callbackItem->lastValues = NULL;
+		callbackItem->callbackCount = 0;
+		callbackItem->callbackSize = 0;
+		callbackItem->staticCount = 0;
+		callbackItem->muxPages = NULL;
+		callbackItem->skipUnchanged = 0;
+		callbackItem->lastValid = 0;
+		callbackItem->framesSkipped = 0;
+		callbackItem->signalsSkipped = 0;
+
+		HASH_ADD_INT(*callbackList, canID, callbackItem);
+	}
+
+	if (reportMode & REPORT_SKIP_UNCHANGED)
+	{
+		callbackItem->skipUnchanged = 1;
+	}
+
+	/* The multiplexer is always reported for multiplexed frames */
+	if (NULL != frame->muxStep)
+	{
+		add_signal_callback(callbackItem, frame->muxStep, callback, onChange, deadband);
+	}
+
+	if (NULL == signal)
+	{
+		/* Subscribe to all signals in message */
+		for (i = 0; i < frame->staticLength; i++)
+		{
+			add_signal_callback(callbackItem, &frame->plan[i], callback, onChange, deadband);
+		}
+		for (i = 0; i < frame->muxPageCount; i++)
+		{
+			for (step = &frame->plan[frame->muxPages[i].first]; step < &frame->plan[frame->muxPages[i].first + frame->muxPages[i].count]; step++)
+			{
+				add_signal_callback(callbackItem, step, callback, onChange, deadband);
+			}
+		}
+	}
+	else
+	{
+		add_signal_callback(callbackItem, step, callback, onChange, deadband);
+	}
+
+	update_mux_index(callbackItem);
+}
+
+void delete_callbacks(signal_callback_list_t *callbackList)
+{
+	signal_callback_list_t *callback, *callback_tmp;
+
+	HASH_ITER(hh, callbackList, callback, callback_tmp)
+	{
+		HASH_DEL(callbackList, callback);
+		free(callback->callbacks);
+		free(callback->lastValues);
+		free(callback->muxPages);
+		free(callback);
+	}
+}
+
+void get_skip_statistics(signal_callback_list_t *callbackList, unsigned long *framesSkipped, unsigned long *signalsSkipped)
+{
+	signal_callback_list_t *callbackItem;
+
+	*framesSkipped = 0;
+	*signalsSkipped = 0;
+	for (callbackItem = callbackList; callbackItem != NULL; callbackItem = callbackItem->hh.next)
+	{
+		*framesSkipped += callbackItem->framesSkipped;
+		*signalsSkipped += callbackItem->signalsSkipped;
+	}
+}
+
+double decoded_physical_value(const decoded_signal_t *decoded)
+{
+	return decodePhysical(decoded->step, decoded->rawValue);
+}
+
+const char *decoded_value_string(const decoded_signal_t *decoded)
+{
+	return (decoded->step->flags & DBC_STEP_VALUES) ? Dbc_FindValueString(Dbc_StepSignal(decoded->frame, decoded->step), decoded->rawValue) : NULL;
+}
+
+static inline void processStep(const Dbc_Frame_t *frame, const Dbc_DecodeStep_t *step, callback_t callback, const struct canfd_frame *cf, __u64 timestamp, char *device)
+{
+	decoded_signal_t decoded;
+
+	decoded.frame = frame;
+	decoded.step = step;
+	decoded.rawValue = decodeRaw(step, cf->data);
+	decoded.canID = cf->can_id;
+	callback(&decoded, timestamp, device);
+}
+
+static inline void processSignalCallback(const Dbc_Frame_t *frame, const signal_callback_t *signalCallback, signal_last_value_t *lastValue, const struct canfd_frame *cf, __u64 timestamp, char *device)
+{
+	const Dbc_DecodeStep_t *step = signalCallback->step;
+	decoded_signal_t decoded;
+	double scaled;
+
+	decoded.frame = frame;
+	decoded.step = step;
+	decoded.rawValue = decodeRaw(step, cf->data);
+	decoded.canID = cf->can_id;
+
+	if (signalCallback->onChange)
+	{
+		if (lastValue->valid && lastValue->rawValue == decoded.rawValue)
+		{
+			return;
+		}
+		if (signalCallback->deadband > 0.)
+		{
+			scaled = decodePhysical(step, decoded.rawValue);
+			/* Enumerations are reported on any change, others when leaving the deadband */
+			if (lastValue->valid && !(step->flags & DBC_STEP_VALUES) && fabs(scaled - lastValue->value) < signalCallback->deadband)
+			{
+				return;
+			}
+			lastValue->value = scaled;
+		}
+		lastValue->rawValue = decoded.rawValue;
+		lastValue->valid = 1;
+	}
+
+	(signalCallback->callback)(&decoded, timestamp, device);
+}
+
+void processAllFrames(const Dbc_Database_t *db, callback_t callback, const struct canfd_frame *cf, __u64 timestamp, char *device)
+{
+	Dbc_Frame_t *frame;
+	const Dbc_MuxPage_t *page;
+	__u64 muxerVal;
+	unsigned int i;
+
+	/* Matching CAN frame, remote and error frames are never decoded */
+	frame = Dbc_IsDataFrame(cf->can_id) ? Dbc_FindFrame(db, cf->can_id) : NULL;
+	if (NULL == frame)
+	{
+		decoded_signal_t decoded = { NULL, NULL, 0, cf->can_id };
+		callback(&decoded, timestamp, device);
+		return;
+	}
+
+	/* Multiplexer and not multiplexed signals */
+	for (i = 0; i < frame->staticLength; i++)
+	{
+		processStep(frame, &frame->plan[i], callback, cf, timestamp, device);
+	}
+
+	/* Signals of the active multiplexer page */
+	if (NULL != frame->muxStep)
+	{
+		muxerVal = decodeRaw(frame->muxStep, cf->data);
+		if (muxerVal < frame->muxPageCount)
+		{
+			page = &frame->muxPages[muxerVal];
+			for (i = page->first; i < page->first + page->count; i++)
+			{
+				processStep(frame, &frame->plan[i], callback, cf, timestamp, device);
+			}
+		}
+	}
+}
+
+void processFrame(signal_callback_list_t *callbackList, const struct canfd_frame *cf, __u64 timestamp, char *device)
+{
+	signal_callback_list_t *callbackItem;
+	const Dbc_MuxPage_t *page = NULL;
+	__u64 muxerVal, delta[CANFD_MAX_DLEN / sizeof(__u64)], changed = 0;
+	const __u8 *staticDelta = NULL, *pageDelta = NULL;
+	unsigned int i, words;
+	canid_t canID = Dbc_NormalizeId(cf->can_id);
+
+	/* Matching CAN frame, remote and error frames are never decoded */
+	if (!Dbc_IsDataFrame(cf->can_id))
+	{
+		return;
+	}
+	HASH_FIND_INT(callbackList, &canID, callbackItem);
+	if (NULL == callbackItem)
+	{
+		return;
+	}
+
+	/* Active page of subscribed multiplexed signals */
+	if (NULL != callbackItem->muxPages)
+	{
+		muxerVal = decodeRaw(callbackItem->frame->muxStep, cf->data);
+		if (muxerVal < callbackItem->frame->muxPageCount)
+		{
+			page = &callbackItem->muxPages[muxerVal];
+		}
+	}
+
+	if (callbackItem->skipUnchanged)
+	{
+		/* Bytes behind the length are zero, so whole words can be compared */
+		words = (cf->len > CAN_MAX_DLEN || callbackItem->frame->dlc > CAN_MAX_DLEN) ? CANFD_MAX_DLEN / sizeof(__u64) : 1;
+		if (callbackItem->lastValid && callbackItem->lastDlc == cf->len)
+		{
+			memcpy(delta, cf->data, words * sizeof(__u64));
+			for (i = 0; i < words; i++)
+			{
+				delta[i] ^= callbackItem->lastPayload[i];
+				changed |= delta[i];
+			}
+			if (0 == changed)
+			{
+				callbackItem->framesSkipped++;
+				callbackItem->signalsSkipped += callbackItem->staticCount + (page ? page->count : 0);
+				return;
+			}
+			staticDelta = (const __u8 *) delta;
+			/* Another page may have been reported last time, its signals can't be compared */
+			if (NULL == callbackItem->frame->muxStep || !stepChanged(callbackItem->frame->muxStep, staticDelta))
+			{
+				pageDelta = staticDelta;
+			}
+		}
+		memcpy(callbackItem->lastPayload, cf->data, words * sizeof(__u64));
+		callbackItem->lastDlc = cf->len;
+		callbackItem->lastValid = 1;
+	}
+
+	/* Multiplexer and not multiplexed signals */
+	for (i = 0; i < callbackItem->staticCount; i++)
+	{
+		if (stepChanged(callbackItem->callbacks[i].step, staticDelta))
+		{
+			processSignalCallback(callbackItem->frame, &callbackItem->callbacks[i], &callbackItem->lastValues[i], cf, timestamp, device);
+		}
+		else
+		{
+			callbackItem->signalsSkipped++;
+		}
+	}
+
+	/* Subscribed signals of the active multiplexer page */
+	if (NULL != page)
+	{
+		for (i = page->first; i < page->first + page->count; i++)
+		{
+			if (stepChanged(callbackItem->callbacks[i].step, pageDelta))
+			{
+				processSignalCallback(callbackItem->frame, &callbackItem->callbacks[i], &callbackItem->lastValues[i], cf, timestamp, device);
+			}
+			else
+			{
+				callbackItem->signalsSkipped++;
+			}
+		}
+	}
+}
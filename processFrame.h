@@ -1,30 +1,146 @@
-/**
- * @file processFrame.h
- *
- * Process Messages and Signals
- */
-
-#ifndef _PROCESSFRAME_H_
-#define _PROCESSFRAME_H_
-
-#include "dbc.h"
-
-typedef void (*callback_t)(const char *, const char *, __u64, const char *, double, struct timeval, char *device);
-
-typedef struct
-{
-	Dbc_Frame_t *frame;
-	Dbc_Signal_t *signal;
-	__u64 rawValue;
-	__u8 onChange;  /* Callback every Signal/Message (0) or only on change of Signal (1) */
-	callback_t callback;
-
-	UT_hash_handle hh;
-} signal_callback_list_t;
-
-void add_callback(signal_callback_list_t **callbackList, Dbc_Frame_t *frame, Dbc_Signal_t *signal, callback_t callback, __u8 onChange);
-void delete_callbacks(signal_callback_list_t *callbackList);
-void processAllFrames(Dbc_Frame_t *frames, callback_t callback, struct can_frame *cf, struct timeval tv, char *device);
-void processFrame(signal_callback_list_t *callbackList, struct can_frame *cf, struct timeval tv, char *device);
-
-#endif
+/**
+ * @file processFrame.h
+ *
+ * Process Messages and Signals
+ */
+
+#ifndef _PROCESSFRAME_H_
+#define _PROCESSFRAME_H_
+
+#include <string.h>
+#include <endian.h>
+#include "uthash.h"
+#include "dbc.h"
+
+/**
+ * Handle of one decoded signal passed to the callbacks. Only the raw value is
+ * computed upfront, the physical value and the value string are computed on
+ * demand by decoded_physical_value() and decoded_value_string().
+ */
+typedef struct
+{
+	const Dbc_Frame_t *frame;      /* NULL if the frame is not part of the database */
+	const Dbc_DecodeStep_t *step;  /* NULL if the frame is not part of the database */
+	__u64 rawValue;
+	canid_t canID;                 /* ID of the received frame */
+} decoded_signal_t;
+
+typedef void (*callback_t)(const decoded_signal_t *decoded, __u64 timestamp, char *device);
+
+/* Report modes of add_callback(), may be combined */
+#define REPORT_ALWAYS          0x00  /* Callback every Signal/Message */
+#define REPORT_ON_CHANGE       0x01  /* Callback only on change of Signal */
+#define REPORT_SKIP_UNCHANGED  0x02  /* Skip frames with an unchanged payload, decode only signals whose bits changed */
+
+typedef struct
+{
+	const Dbc_DecodeStep_t *step;
+	__u8 onChange;  /* Callback every Signal/Message (0) or only on change of Signal (1) */
+	double deadband;  /* On change: minimal change of the physical value to be reported (0 = any raw change) */
+	callback_t callback;
+} signal_callback_t;
+
+/* Last reported value of a signal, used by the on change mode */
+typedef struct
+{
+	__u64 rawValue;
+	double value;  /* Only maintained if a deadband is used */
+	__u8 valid;
+} signal_last_value_t;
+
+/* All subscriptions of one CAN ID, hashed by the normalized frame ID */
+typedef struct
+{
+	canid_t canID;
+	Dbc_Frame_t *frame;
+	signal_callback_t *callbacks;  /**< Sorted in plan order of the frame */
+	signal_last_value_t *lastValues;  /**< Same order as callbacks */
+	unsigned int callbackCount;
+	unsigned int callbackSize;
+	unsigned int staticCount;      /**< Callbacks decoded regardless of the multiplexer value */
+	Dbc_MuxPage_t *muxPages;       /**< Ranges of callbacks, indexed by multiplexer value */
+	__u8 skipUnchanged;            /**< REPORT_SKIP_UNCHANGED was requested */
+	__u8 lastDlc;
+	__u8 lastValid;
+	__u64 lastPayload[CANFD_MAX_DLEN / sizeof(__u64)];  /**< Payload of the last frame, compared word wise */
+	unsigned long framesSkipped;
+	unsigned long signalsSkipped;
+
+	UT_hash_handle hh;
+} signal_callback_list_t;
+
+double decoded_physical_value(const decoded_signal_t *decoded);
+const char *decoded_value_string(const decoded_signal_t *decoded);
+
+void add_callback(signal_callback_list_t **callbackList, Dbc_Frame_t *frame, Dbc_Signal_t *signal, callback_t callback, __u8 reportMode, double deadband);
+void delete_callbacks(signal_callback_list_t *callbackList);
+void get_skip_statistics(signal_callback_list_t *callbackList, unsigned long *framesSkipped, unsigned long *signalsSkipped);
+void processAllFrames(const Dbc_Database_t *db, callback_t callback, const struct canfd_frame *cf, __u64 timestamp, char *device);
+void processFrame(signal_callback_list_t *callbackList, const struct canfd_frame *cf, __u64 timestamp, char *device);
+
+/* Signal extraction kernel, inline for the decode loops of processFrame.c and the tests */
+
+/**
+ * @brief      Reads 8 payload bytes as one little endian word
+ *
+ * @param[in]  data  The payload bytes
+ *
+ * @return     The payload word, data[0] in the least significant byte
+ */
+static inline __u64 loadPayload(const __u8 *data)
+{
+	__u64 payload;
+
+	memcpy(&payload, data, sizeof(payload));
+	return le64toh(payload);
+}
+
+/**
+ * @brief      Extracts the bits of a signal using its precompiled decode step
+ *
+ * @param[in]  step  The decode step
+ * @param[in]  data  The frame payload (CANFD_MAX_DLEN bytes)
+ *
+ * @return     The raw value, not sign extended
+ */
+static inline __u64 extractBits(const Dbc_DecodeStep_t *step, const __u8 *data)
+{
+	__u64 payload;
+
+	/* Unused steps have length 0, which must not become a shift by 64 */
+	if (0 == step->length)
+	{
+		return 0;
+	}
+
+	payload = loadPayload(data + step->byteOffset);
+	if (step->flags & DBC_STEP_BIG_ENDIAN)
+	{
+		payload = __builtin_bswap64(payload);
+	}
+
+	return (payload >> step->shift) & (~0ULL >> (64 - step->length));
+}
+
+/**
+ * @brief      Extracts the raw value of a signal using its precompiled decode step
+ *
+ * @param[in]  step  The decode step
+ * @param[in]  data  The frame payload (CANFD_MAX_DLEN bytes)
+ *
+ * @return     The raw value, sign extended for signed signals
+ */
+static inline __u64 decodeRaw(const Dbc_DecodeStep_t *step, const __u8 *data)
+{
+	__u64 raw = extractBits(step, data);
+	unsigned int unused = (64 - step->length) % 64;
+
+	if (step->flags & DBC_STEP_SIGNED)
+	{
+		return (__u64) ((__s64) (raw << unused) >> unused);
+	}
+
+	return raw;
+}
+
+#endif
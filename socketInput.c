@@ -0,0 +1,250 @@
+/**
+ * @file socketInput.c
+ *
+ * Live frames from SocketCAN raw sockets
+ */
+
+/**
+Section: Included Files
+*/
+
+#define _GNU_SOURCE  /* recvmmsg() */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <linux/can/raw.h>
+#include "socketInput.h"
+#include "parseLine.h"
+
+/**
+Section: Definitions
+*/
+
+#define NSEC_PER_SEC 1000000000ULL
+#define NSEC_PER_USEC 1000ULL
+
+#define SOCKET_INPUT_CONTROL_SIZE (CMSG_SPACE(sizeof(struct timeval)) + CMSG_SPACE(sizeof(__u32)))
+
+/**
+Section: Private functions
+*/
+
+/**
+ * @brief      Returns the name of an interface, looked up once per change of interface
+ */
+static char *SocketInput_DeviceName(SocketInput_t *input, int ifindex)
+{
+	if (ifindex != input->ifindex)
+	{
+		if (NULL == if_indextoname(ifindex, input->name))
+		{
+			strcpy(input->name, "unknown");
+		}
+		input->ifindex = ifindex;
+	}
+
+	return input->name;
+}
+
+static int SocketInput_CompareIds(const void *a, const void *b)
+{
+	canid_t idA = *(const canid_t *) a;
+	canid_t idB = *(const canid_t *) b;
+
+	return (idA > idB) - (idA < idB);
+}
+
+/**
+Section: Implementation
+*/
+
+int SocketInput_Open(SocketInput_t *input, const char *interface)
+{
+	struct sockaddr_can addr;
+	int enable = 1;
+
+	memset(input, 0, sizeof(SocketInput_t));
+	memset(&addr, 0, sizeof(addr));
+	addr.can_family = AF_CAN;
+
+	if (strcmp(interface, "any") != 0)
+	{
+		addr.can_ifindex = if_nametoindex(interface);
+		if (0 == addr.can_ifindex)
+		{
+			return -1;
+		}
+	}
+
+	input->fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+	if (input->fd < 0)
+	{
+		return -1;
+	}
+
+	/* CAN FD frames are optional, interfaces without FD support still work */
+	setsockopt(input->fd, SOL_CAN_RAW, CAN_RAW_FD_FRAMES, &enable, sizeof(enable));
+
+	if (setsockopt(input->fd, SOL_SOCKET, SO_TIMESTAMP, &enable, sizeof(enable)) < 0 ||
+		setsockopt(input->fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) < 0 ||
+		bind(input->fd, (struct sockaddr *) &addr, sizeof(addr)) < 0)
+	{
+		close(input->fd);
+		input->fd = -1;
+		return -1;
+	}
+
+	return 0;
+}
+
+int SocketInput_SetFilter(SocketInput_t *input, const canid_t *ids, unsigned int count)
+{
+	struct can_filter filters[CAN_RAW_FILTER_MAX];
+	unsigned int filterCount = 0, unique = 0, i;
+	canid_t *sorted, idMask, size;
+
+	sorted = malloc((count ? count : 1) * sizeof(canid_t));
+	if (NULL == sorted)
+	{
+		return -1;
+	}
+	memcpy(sorted, ids, count * sizeof(canid_t));
+	qsort(sorted, count, sizeof(canid_t), SocketInput_CompareIds);
+	for (i = 0; i < count; i++)
+	{
+		/* A standard ID above CAN_SFF_MASK can't be received, and an 11 bit mask would pass other IDs */
+		if (!(sorted[i] & CAN_EFF_FLAG) && sorted[i] > CAN_SFF_MASK)
+		{
+			continue;
+		}
+		if (0 == unique || sorted[unique - 1] != sorted[i])
+		{
+			sorted[unique++] = sorted[i];
+		}
+	}
+
+	for (i = 0; i < unique; i += size)
+	{
+		if (filterCount == CAN_RAW_FILTER_MAX)
+		{
+			/* Too many filters, the kernel would refuse them anyway */
+			free(sorted);
+			input->filters = 0;
+			return 0;
+		}
+
+		/* Grow an aligned block while all of its IDs are requested */
+		idMask = (sorted[i] & CAN_EFF_FLAG) ? CAN_EFF_MASK : CAN_SFF_MASK;
+		size = 1;
+		while ((size << 1) <= idMask && 0 == (sorted[i] & ((size << 1) - 1)) &&
+			i + (size << 1) <= unique && sorted[i + (size << 1) - 1] == sorted[i] + (size << 1) - 1)
+		{
+			size <<= 1;
+		}
+
+		/* The frame format has to match, RTR frames carry no signals */
+		filters[filterCount].can_id = sorted[i];
+		filters[filterCount].can_mask = (idMask & ~(size - 1)) | CAN_EFF_FLAG | CAN_RTR_FLAG;
+		filterCount++;
+	}
+	free(sorted);
+
+	if (setsockopt(input->fd, SOL_CAN_RAW, CAN_RAW_FILTER, filters, filterCount * sizeof(struct can_filter)) < 0)
+	{
+		return -1;
+	}
+	input->filters = filterCount;
+
+	return filterCount;
+}
+
+int SocketInput_Receive(SocketInput_t *input, FrameHandler_t handler, void *context)
+{
+	struct canfd_frame frames[SOCKET_INPUT_BATCH];
+	struct sockaddr_can addr[SOCKET_INPUT_BATCH];
+	struct iovec iov[SOCKET_INPUT_BATCH];
+	struct mmsghdr msgs[SOCKET_INPUT_BATCH];
+	char control[SOCKET_INPUT_BATCH][SOCKET_INPUT_CONTROL_SIZE] __attribute__((aligned(sizeof(size_t))));
+	struct cmsghdr *cmsg;
+	struct timeval tv;
+	__u64 timestamp;
+	int count, i;
+
+	for (i = 0; i < SOCKET_INPUT_BATCH; i++)
+	{
+		iov[i].iov_base = &frames[i];
+		iov[i].iov_len = CANFD_MTU;
+		msgs[i].msg_hdr.msg_name = &addr[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_can);
+		msgs[i].msg_hdr.msg_iov = &iov[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+		msgs[i].msg_hdr.msg_control = control[i];
+		msgs[i].msg_hdr.msg_controllen = SOCKET_INPUT_CONTROL_SIZE;
+		msgs[i].msg_hdr.msg_flags = 0;
+	}
+
+	/* Block for the first frame, then take whatever else is queued */
+	count = recvmmsg(input->fd, msgs, SOCKET_INPUT_BATCH, MSG_WAITFORONE, NULL);
+	if (count < 0)
+	{
+		return (EINTR == errno) ? 0 : -1;
+	}
+
+	for (i = 0; i < count; i++)
+	{
+		if (CAN_MTU == msgs[i].msg_len)
+		{
+			frames[i].flags = 0;
+		}
+		else if (CANFD_MTU == msgs[i].msg_len)
+		{
+			frames[i].flags |= CANFD_FDF;
+		}
+		else
+		{
+			continue;
+		}
+
+		timestamp = 0;
+		for (cmsg = CMSG_FIRSTHDR(&msgs[i].msg_hdr); cmsg != NULL; cmsg = CMSG_NXTHDR(&msgs[i].msg_hdr, cmsg))
+		{
+			if (SOL_SOCKET != cmsg->cmsg_level)
+			{
+				continue;
+			}
+			if (SO_TIMESTAMP == cmsg->cmsg_type)
+			{
+				memcpy(&tv, CMSG_DATA(cmsg), sizeof(tv));
+				timestamp = tv.tv_sec * NSEC_PER_SEC + tv.tv_usec * NSEC_PER_USEC;
+			}
+			else if (SO_RXQ_OVFL == cmsg->cmsg_type)
+			{
+				memcpy(&input->drops, CMSG_DATA(cmsg), sizeof(__u32));
+			}
+		}
+
+		/* Same as frames parsed from text: no stale bytes behind the length */
+		if (frames[i].len > CANFD_MAX_DLEN)
+		{
+			continue;
+		}
+		memset(frames[i].data + frames[i].len, 0, CANFD_MAX_DLEN - frames[i].len);
+
+		input->frames++;
+		handler(&frames[i], timestamp, SocketInput_DeviceName(input, addr[i].can_ifindex), context);
+	}
+
+	return count;
+}
+
+void SocketInput_Close(SocketInput_t *input)
+{
+	if (input->fd >= 0)
+	{
+		close(input->fd);
+		input->fd = -1;
+	}
+}
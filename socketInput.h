@@ -0,0 +1,88 @@
+/**
+ * @file socketInput.h
+ *
+ * Live frames from SocketCAN raw sockets
+ */
+
+#ifndef _SOCKETINPUT_H_
+#define _SOCKETINPUT_H_
+
+#include <net/if.h>
+#include <linux/can.h>
+
+/**
+Section: Definitions
+*/
+
+#define SOCKET_INPUT_BATCH 64  /**< Frames received per recvmmsg() call */
+
+/**
+Section: Public Types
+*/
+
+/**
+ * Handles one received classic or CAN FD frame, device is the name of the
+ * receiving interface
+ */
+typedef void (*FrameHandler_t)(const struct canfd_frame *cf, __u64 timestamp, char *device, void *context);
+
+typedef struct
+{
+	int fd;
+	int ifindex;              /**< Interface the cached name belongs to */
+	char name[IF_NAMESIZE];   /**< Name of the last receiving interface */
+	unsigned long frames;     /**< Frames received */
+	__u32 drops;              /**< Frames dropped by the kernel, from SO_RXQ_OVFL */
+	unsigned int filters;     /**< Installed CAN_RAW_FILTER entries, 0 receives everything */
+} SocketInput_t;
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Opens a CAN_RAW socket with kernel timestamps and drop counts
+ *
+ * @param      input      The input
+ * @param[in]  interface  The interface name, "any" receives from all CAN interfaces
+ *
+ * @return     0 on success and a negative value otherwise (errno is set)
+ */
+int SocketInput_Open(SocketInput_t *input, const char *interface);
+
+/**
+ * @brief      Lets the kernel drop all frames except the given IDs
+ *
+ * Runs of consecutive IDs that form an aligned power of two block are merged
+ * into a single ID/mask pair, so the filter never passes other IDs. Only
+ * data frames pass. Standard IDs above CAN_SFF_MASK are left out, no frame
+ * can have them. If more than CAN_RAW_FILTER_MAX entries would be needed, no
+ * filter is installed.
+ *
+ * @param      input  The input
+ * @param[in]  ids    Normalized frame IDs (see Dbc_NormalizeId())
+ * @param[in]  count  Number of IDs
+ *
+ * @return     Number of installed filters and a negative value on errors
+ */
+int SocketInput_SetFilter(SocketInput_t *input, const canid_t *ids, unsigned int count);
+
+/**
+ * @brief      Waits for frames and handles a batch of them
+ *
+ * @param      input    The input
+ * @param[in]  handler  Called for every frame
+ * @param      context  Passed to handler
+ *
+ * @return     Number of frames received, 0 if interrupted by a signal and a negative value on errors
+ */
+int SocketInput_Receive(SocketInput_t *input, FrameHandler_t handler, void *context);
+
+/**
+ * @brief      Closes the socket
+ *
+ * @param      input  The input
+ */
+void SocketInput_Close(SocketInput_t *input);
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * @file spscRing.c
+ *
+ * Bounded lock-free single-producer/single-consumer ring of pointers
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdlib.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include "spscRing.h"
+
+/**
+Section: Definitions
+*/
+
+#define SPSC_RING_SPINS   64    /* Busy polls before yielding */
+#define SPSC_RING_YIELDS  64    /* Yields before blocking */
+
+/**
+Section: Private functions
+*/
+
+/**
+ * @brief      Backs off while waiting for the other side of a ring
+ *
+ * @param      attempt  Number of unsuccessful polls so far, incremented
+ *
+ * @return     1 once the spins and yields are used up and the caller should block, 0 otherwise
+ */
+static int SpscRing_Backoff(unsigned int *attempt)
+{
+	if (*attempt < SPSC_RING_SPINS)
+	{
+		(*attempt)++;
+	}
+	else if (*attempt < SPSC_RING_SPINS + SPSC_RING_YIELDS)
+	{
+		(*attempt)++;
+		sched_yield();
+	}
+	else
+	{
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ * @brief      Blocks until the other side of a ring moves its position
+ *
+ * The flag is set before the position is checked again, and the other side
+ * stores its position before it checks the flag (see SpscRing_Wake()), so
+ * one of both sees the other and a wakeup can't be lost.
+ *
+ * @param      waiting   Futex of the waiting side
+ * @param      position  Position of the other side
+ * @param[in]  seen      The position while the ring is empty or full
+ */
+static void SpscRing_Block(atomic_uint *waiting, atomic_size_t *position, size_t seen)
+{
+	atomic_store_explicit(waiting, 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load_explicit(position, memory_order_relaxed) == seen)
+	{
+		syscall(SYS_futex, waiting, FUTEX_WAIT_PRIVATE, 1, NULL, NULL, 0);
+	}
+	atomic_store_explicit(waiting, 0, memory_order_relaxed);
+}
+
+/**
+ * @brief      Wakes the other side of a ring if it blocks, after moving the own position
+ *
+ * @param      waiting  Futex of the other side
+ */
+static void SpscRing_Wake(atomic_uint *waiting)
+{
+	atomic_thread_fence(memory_order_seq_cst);
+	if (atomic_load_explicit(waiting, memory_order_relaxed))
+	{
+		atomic_store_explicit(waiting, 0, memory_order_relaxed);
+		syscall(SYS_futex, waiting, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+	}
+}
+
+/**
+Section: Implementation
+*/
+
+int SpscRing_Init(SpscRing_t *ring, size_t capacity)
+{
+	size_t size = 1;
+
+	while (size < capacity)
+	{
+		size <<= 1;
+	}
+
+	ring->items = malloc(size * sizeof(void *));
+	if (NULL == ring->items)
+	{
+		return -1;
+	}
+	ring->mask = size - 1;
+	ring->maxDepth = 0;
+	ring->overflows = 0;
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+	atomic_init(&ring->pushWaiting, 0);
+	atomic_init(&ring->popWaiting, 0);
+
+	return 0;
+}
+
+void SpscRing_DeInit(SpscRing_t *ring)
+{
+	free(ring->items);
+	ring->items = NULL;
+}
+
+/**
+ * @brief      Queues an item without counting a full ring as overflow
+ */
+static int SpscRing_TryPush(SpscRing_t *ring, void *item)
+{
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+	size_t depth = head - tail;
+
+	if (depth > ring->mask)
+	{
+		return -1;
+	}
+
+	ring->items[head & ring->mask] = item;
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+	SpscRing_Wake(&ring->popWaiting);
+
+	if (depth + 1 > ring->maxDepth)
+	{
+		ring->maxDepth = depth + 1;
+	}
+
+	return 0;
+}
+
+int SpscRing_Push(SpscRing_t *ring, void *item)
+{
+	if (SpscRing_TryPush(ring, item))
+	{
+		ring->overflows++;
+		return -1;
+	}
+
+	return 0;
+}
+
+int SpscRing_Pop(SpscRing_t *ring, void **item)
+{
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	size_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+
+	if (head == tail)
+	{
+		return -1;
+	}
+
+	*item = ring->items[tail & ring->mask];
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+	SpscRing_Wake(&ring->pushWaiting);
+
+	return 0;
+}
+
+void SpscRing_PushWait(SpscRing_t *ring, void *item)
+{
+	unsigned int attempt = 0;
+
+	if (0 == SpscRing_Push(ring, item))
+	{
+		return;
+	}
+	while (SpscRing_TryPush(ring, item))
+	{
+		if (SpscRing_Backoff(&attempt))
+		{
+			/* Full as long as the consumer is a whole ring behind */
+			SpscRing_Block(&ring->pushWaiting, &ring->tail,
+				atomic_load_explicit(&ring->head, memory_order_relaxed) - ring->mask - 1);
+		}
+	}
+}
+
+void *SpscRing_PopWait(SpscRing_t *ring)
+{
+	unsigned int attempt = 0;
+	void *item;
+
+	while (SpscRing_Pop(ring, &item))
+	{
+		if (SpscRing_Backoff(&attempt))
+		{
+			/* Empty as long as the producer is at the own position */
+			SpscRing_Block(&ring->popWaiting, &ring->head, atomic_load_explicit(&ring->tail, memory_order_relaxed));
+		}
+	}
+
+	return item;
+}
@@ -0,0 +1,90 @@
+/**
+ * @file spscRing.h
+ *
+ * Bounded lock-free single-producer/single-consumer ring of pointers. The
+ * waiting functions spin and yield for a while and then block on a futex
+ * until the other side pushes or pops.
+ */
+
+#ifndef _SPSCRING_H_
+#define _SPSCRING_H_
+
+#include <stddef.h>
+#include <stdatomic.h>
+
+/**
+Section: Definitions
+*/
+
+#define SPSC_RING_CACHE_LINE 64
+
+/**
+Section: Public Types
+*/
+
+typedef struct
+{
+	_Alignas(SPSC_RING_CACHE_LINE) atomic_size_t head;  /**< Next slot written by the producer */
+	atomic_uint pushWaiting; /**< Futex, set while the producer blocks on a full ring */
+	size_t maxDepth;         /**< Highest number of queued items seen by the producer */
+	unsigned long overflows; /**< Pushes that found the ring full */
+
+	_Alignas(SPSC_RING_CACHE_LINE) atomic_size_t tail;  /**< Next slot read by the consumer */
+	atomic_uint popWaiting;  /**< Futex, set while the consumer blocks on an empty ring */
+
+	_Alignas(SPSC_RING_CACHE_LINE) void **items;
+	size_t mask;
+} SpscRing_t;
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Allocates a ring
+ *
+ * @param      ring      The ring
+ * @param[in]  capacity  Number of slots, rounded up to a power of two
+ *
+ * @return     0 on success and a negative value otherwise
+ */
+int SpscRing_Init(SpscRing_t *ring, size_t capacity);
+
+/**
+ * @brief      Frees a ring, queued items are not freed
+ *
+ * @param      ring  The ring
+ */
+void SpscRing_DeInit(SpscRing_t *ring);
+
+/**
+ * @brief      Queues an item, producer side only
+ *
+ * @param      ring  The ring
+ * @param      item  The item
+ *
+ * @return     0 on success and a negative value if the ring is full (counted as overflow)
+ */
+int SpscRing_Push(SpscRing_t *ring, void *item);
+
+/**
+ * @brief      Dequeues an item, consumer side only
+ *
+ * @param      ring  The ring
+ * @param[out] item  The item
+ *
+ * @return     0 on success and a negative value if the ring is empty
+ */
+int SpscRing_Pop(SpscRing_t *ring, void **item);
+
+/**
+ * @brief      Like SpscRing_Push(), but waits while the ring is full
+ */
+void SpscRing_PushWait(SpscRing_t *ring, void *item);
+
+/**
+ * @brief      Like SpscRing_Pop(), but waits while the ring is empty
+ */
+void *SpscRing_PopWait(SpscRing_t *ring);
+
+#endif
@@ -0,0 +1,125 @@
+/**
+ * @file bench.c
+ *
+ * Benchmarks of the decoder, run by "make bench"
+ *
+ * Usage: bench [name ...], all benchmarks are run without names.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bench.h"
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	const char *name;
+	const char *description;
+	void (*run)(void);
+} Bench_t;
+
+/**
+Section: Private data
+*/
+
+static const Bench_t benches[] =
+{
+	{ "lookup", "frame lookup cost for growing databases (processAllFrames)", BenchLookup_Run },
+	{ "plan", "signals/s of the decode plans against the signal walk they replaced", BenchPlan_Run },
+	{ "extract", "ns/signal of the extraction kernel against the byte wise extractor", BenchExtract_Run },
+	{ "parse", "candump -L lines/s of parseLine against sscanf and parse_canframe", BenchParse_Run },
+	{ "fd", "signals/s of 64 byte CAN FD payloads against 8 byte payloads", BenchFd_Run },
+	{ "read", "frames/s read from text logs (LineReader, getline) and frame logs", BenchRead_Run },
+	{ "load", "load time of synthetic DBC files with 100 to 10000 messages", BenchLoad_Run },
+	{ "all", "frames/s in all mode with the packed decode steps and the previous layout", BenchAll_Run },
+};
+
+/**
+Section: Public Data
+*/
+
+volatile uint64_t Bench_Sink;
+uint64_t Bench_Signals;
+
+/**
+Section: Implementation
+*/
+
+uint64_t Bench_Now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+double Bench_Measure(Bench_Work_t work, void *context, double items)
+{
+	uint64_t start, elapsed;
+	unsigned long calls;
+	double best = 0.;
+	unsigned int round;
+
+	/* Warm up caches and branch predictors */
+	work(context);
+
+	for (round = 0; round < BENCH_ROUNDS; round++)
+	{
+		calls = 0;
+		start = Bench_Now();
+		do
+		{
+			work(context);
+			calls++;
+			elapsed = Bench_Now() - start;
+		} while (elapsed < BENCH_MIN_NSEC);
+
+		if (0 == round || elapsed / (calls * items) < best)
+		{
+			best = elapsed / (calls * items);
+		}
+	}
+
+	return best;
+}
+
+void Bench_CountCallback(const decoded_signal_t *decoded, __u64 timestamp, char *device)
+{
+	(void) timestamp;
+	(void) device;
+
+	Bench_Sink += decoded->rawValue;
+	Bench_Signals++;
+}
+
+int main(int argc, char **argv)
+{
+	unsigned int i;
+	int j, selected;
+
+	for (i = 0; i < sizeof(benches) / sizeof(benches[0]); i++)
+	{
+		selected = (argc < 2);
+		for (j = 1; j < argc; j++)
+		{
+			selected |= !strcmp(argv[j], benches[i].name);
+		}
+		if (selected)
+		{
+			printf("== %s: %s\n", benches[i].name, benches[i].description);
+			benches[i].run();
+			fflush(stdout);
+		}
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file bench.h
+ *
+ * Benchmarks of the decoder, run by "make bench"
+ */
+
+#ifndef _BENCH_H_
+#define _BENCH_H_
+
+#include <stdint.h>
+#include "processFrame.h"
+
+/**
+Section: Definitions
+*/
+
+#define BENCH_MIN_NSEC 100000000ULL  /**< Minimal duration of one measurement */
+#define BENCH_ROUNDS   3             /**< Measurements, the fastest one is reported */
+
+/**
+Section: Public Types
+*/
+
+/** Processes a fixed amount of work, called repeatedly by Bench_Measure() */
+typedef void (*Bench_Work_t)(void *context);
+
+/**
+Section: Public Data
+*/
+
+/** Sum of decoded values, keeps the compiler from dropping the work */
+extern volatile uint64_t Bench_Sink;
+
+/** Signals seen by Bench_CountCallback() */
+extern uint64_t Bench_Signals;
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Returns a monotonic timestamp
+ *
+ * @return     The timestamp in nanoseconds
+ */
+uint64_t Bench_Now(void);
+
+/**
+ * @brief      Measures the time work takes per item
+ *
+ * work is repeated for at least BENCH_MIN_NSEC, BENCH_ROUNDS times.
+ *
+ * @param[in]  work     The work
+ * @param      context  Passed to work
+ * @param[in]  items    Items processed by one call of work
+ *
+ * @return     Nanoseconds per item of the fastest round
+ */
+double Bench_Measure(Bench_Work_t work, void *context, double items);
+
+/**
+ * @brief      callback_t counting the decoded signals, without any output
+ */
+void Bench_CountCallback(const decoded_signal_t *decoded, __u64 timestamp, char *device);
+
+/* The benchmarks, one per file */
+void BenchLookup_Run(void);
+void BenchPlan_Run(void);
+void BenchExtract_Run(void);
+void BenchParse_Run(void);
+void BenchFd_Run(void);
+void BenchRead_Run(void);
+void BenchLoad_Run(void);
+void BenchAll_Run(void);
+
+#endif
@@ -0,0 +1,277 @@
+/**
+ * @file benchAll.c
+ *
+ * all mode: frames/s of processAllFrames(), of the decode loop over the
+ * packed 24 byte decode steps and of the same loop over the previous 56
+ * byte steps, which also held the masks and a pointer to the signal. The
+ * end to end row parses candump -L lines and prints every signal like
+ * candecode does, into /dev/null.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bench.h"
+#include "support.h"
+#include "parseLine.h"
+
+/**
+Section: Definitions
+*/
+
+#define BENCH_ALL_FRAMES 4096
+#define NSEC_PER_SEC     1000000000ULL
+#define NSEC_PER_USEC    1000ULL
+
+/**
+Section: Private Types
+*/
+
+/** Dbc_DecodeStep_t before the hot/cold split */
+typedef struct
+{
+	uint64_t mask;
+	uint64_t signMask;
+	uint64_t payloadMask;
+	double factor;
+	double offset;
+	uint8_t byteOffset;
+	uint8_t shift;
+	uint8_t is_big_endian;
+	uint8_t scale;
+	uint8_t isMultiplexer;
+	uint8_t hasValues;
+	uint16_t muxId;
+	Dbc_Signal_t *signal;
+} BenchAll_WideStep_t;
+
+typedef struct
+{
+	Dbc_Database_t *db;
+	struct canfd_frame *frames;
+	BenchAll_WideStep_t **wideSteps;  /**< Per frame of the database, in plan order */
+	char *log;
+	size_t size;
+} BenchAll_t;
+
+/**
+Section: Private data
+*/
+
+static FILE *output;
+
+/**
+Section: Private functions
+*/
+
+/* printCallback() of main.c */
+static void BenchAll_PrintCallback(const decoded_signal_t *decoded, __u64 timestamp, char *device)
+{
+	const char *stringValue;
+
+	if (NULL == decoded->frame)
+	{
+		fprintf(output, "(%04llu.%06llu) %s: Frame 0x%02x not found\n", timestamp / NSEC_PER_SEC, (timestamp % NSEC_PER_SEC) / NSEC_PER_USEC, device, decoded->canID);
+		return;
+	}
+
+	stringValue = decoded_value_string(decoded);
+	if (NULL != stringValue)
+	{
+		fprintf(output, "(%04llu.%06llu) %s %s.%s: 0x%02llx \"%s\"\n", timestamp / NSEC_PER_SEC, (timestamp % NSEC_PER_SEC) / NSEC_PER_USEC, device,
+			decoded->frame->name, Dbc_StepSignal(decoded->frame, decoded->step)->name, decoded->rawValue, stringValue);
+	}
+	else
+	{
+		fprintf(output, "(%04llu.%06llu) %s %s.%s: 0x%02llx %f\n", timestamp / NSEC_PER_SEC, (timestamp % NSEC_PER_SEC) / NSEC_PER_USEC, device,
+			decoded->frame->name, Dbc_StepSignal(decoded->frame, decoded->step)->name, decoded->rawValue, decoded_physical_value(decoded));
+	}
+}
+
+static void BenchAll_ProcessAllFrames(void *context)
+{
+	BenchAll_t *bench = context;
+	unsigned int i;
+
+	for (i = 0; i < BENCH_ALL_FRAMES; i++)
+	{
+		processAllFrames(bench->db, Bench_CountCallback, &bench->frames[i], 0, "can0");
+	}
+}
+
+static void BenchAll_Steps(void *context)
+{
+	BenchAll_t *bench = context;
+	const Dbc_Frame_t *frame;
+	const Dbc_DecodeStep_t *step;
+	__u64 raw;
+	unsigned int i;
+
+	for (i = 0; i < BENCH_ALL_FRAMES; i++)
+	{
+		frame = Dbc_FindFrame(bench->db, bench->frames[i].can_id);
+		for (step = frame->plan; step < frame->plan + frame->staticLength; step++)
+		{
+			raw = decodeRaw(step, bench->frames[i].data);
+			Bench_Sink += raw + (uint64_t) (raw * step->factor + step->offset);
+		}
+	}
+}
+
+static void BenchAll_WideSteps(void *context)
+{
+	BenchAll_t *bench = context;
+	const Dbc_Frame_t *frame;
+	const BenchAll_WideStep_t *step;
+	__u64 payload, raw;
+	unsigned int i, s;
+
+	for (i = 0; i < BENCH_ALL_FRAMES; i++)
+	{
+		frame = Dbc_FindFrame(bench->db, bench->frames[i].can_id);
+		step = bench->wideSteps[frame - bench->db->frames];
+		for (s = 0; s < frame->staticLength; s++, step++)
+		{
+			payload = loadPayload(bench->frames[i].data + step->byteOffset);
+			if (step->is_big_endian)
+			{
+				payload = __builtin_bswap64(payload);
+			}
+			raw = (payload >> step->shift) & step->mask;
+			raw = (raw ^ step->signMask) - step->signMask;
+			Bench_Sink += raw + (uint64_t) (raw * step->factor + step->offset);
+		}
+	}
+}
+
+/* Lines to printed signals, like "candecode Database all" */
+static void BenchAll_EndToEnd(void *context)
+{
+	BenchAll_t *bench = context;
+	const char *line = bench->log, *end = bench->log + bench->size, *newline, *deviceName;
+	char device[IF_NAMESIZE];
+	struct canfd_frame cf;
+	size_t deviceLength;
+	__u64 timestamp;
+
+	while (line < end)
+	{
+		newline = memchr(line, '\n', end - line);
+		if (parseLine(line, newline - line, NULL, &timestamp, &deviceName, &deviceLength, &cf) || deviceLength >= IF_NAMESIZE)
+		{
+			exit(EXIT_FAILURE);
+		}
+		memcpy(device, deviceName, deviceLength);
+		device[deviceLength] = '\0';
+		processAllFrames(bench->db, BenchAll_PrintCallback, &cf, timestamp, device);
+		line = newline + 1;
+	}
+}
+
+/* Rebuilds the steps of the database in the previous layout */
+static void BenchAll_BuildWideSteps(BenchAll_t *bench)
+{
+	const Dbc_Frame_t *frame;
+	const Dbc_DecodeStep_t *step;
+	BenchAll_WideStep_t *wide;
+	unsigned int f, s;
+
+	bench->wideSteps = calloc(bench->db->frameCount, sizeof(BenchAll_WideStep_t *));
+	for (f = 0; NULL != bench->wideSteps && f < bench->db->frameCount; f++)
+	{
+		frame = &bench->db->frames[f];
+		wide = calloc(frame->staticLength + 1, sizeof(BenchAll_WideStep_t));
+		if (NULL == wide)
+		{
+			exit(EXIT_FAILURE);
+		}
+		bench->wideSteps[f] = wide;
+		for (s = 0; s < frame->staticLength; s++)
+		{
+			step = &frame->plan[s];
+			wide[s].mask = (step->length < 64) ? (1ULL << step->length) - 1 : ~0ULL;
+			wide[s].signMask = (step->flags & DBC_STEP_SIGNED) ? 1ULL << (step->length - 1) : 0;
+			wide[s].payloadMask = wide[s].mask << step->shift;
+			wide[s].factor = step->factor;
+			wide[s].offset = step->offset;
+			wide[s].byteOffset = step->byteOffset;
+			wide[s].shift = step->shift;
+			wide[s].is_big_endian = !!(step->flags & DBC_STEP_BIG_ENDIAN);
+			wide[s].scale = DBC_STEP_SCALE(step->flags);
+			wide[s].hasValues = !!(step->flags & DBC_STEP_VALUES);
+			wide[s].muxId = step->muxId;
+			wide[s].signal = Dbc_StepSignal(frame, step);
+		}
+	}
+	if (NULL == bench->wideSteps)
+	{
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void BenchAll_Measure(const Support_DbcOptions_t *options)
+{
+	BenchAll_t bench;
+	uint64_t state = 1;
+	unsigned int i;
+	double all, steps, wide, endToEnd;
+
+	bench.db = Support_Database(options);
+	bench.frames = malloc(BENCH_ALL_FRAMES * sizeof(struct canfd_frame));
+	bench.log = Support_Log(&state, options, BENCH_ALL_FRAMES, &bench.size);
+	if (NULL == bench.frames || NULL == bench.log)
+	{
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < BENCH_ALL_FRAMES; i++)
+	{
+		Support_Frame(&state, options, Support_Random(&state) % options->messages, &bench.frames[i]);
+	}
+	BenchAll_BuildWideSteps(&bench);
+
+	all = Bench_Measure(BenchAll_ProcessAllFrames, &bench, BENCH_ALL_FRAMES);
+	steps = Bench_Measure(BenchAll_Steps, &bench, BENCH_ALL_FRAMES);
+	wide = Bench_Measure(BenchAll_WideSteps, &bench, BENCH_ALL_FRAMES);
+	endToEnd = Bench_Measure(BenchAll_EndToEnd, &bench, BENCH_ALL_FRAMES);
+	printf("%5u x %2u %16.0f %16.0f %16.0f %8.2fx %14.0f\n", options->messages, options->signals,
+		1e9 / all, 1e9 / steps, 1e9 / wide, wide / steps, 1e9 / endToEnd);
+
+	for (i = 0; i < bench.db->frameCount; i++)
+	{
+		free(bench.wideSteps[i]);
+	}
+	free(bench.wideSteps);
+	free(bench.log);
+	free(bench.frames);
+	Dbc_DeInit(bench.db);
+}
+
+/**
+Section: Implementation
+*/
+
+void BenchAll_Run(void)
+{
+	static const unsigned int sizes[] = { 100, 1000, 10000 };
+	Support_DbcOptions_t options = { 0, 8, CAN_MAX_DLEN, 16, 1 };
+	unsigned int s;
+
+	output = fopen("/dev/null", "w");
+	if (NULL == output)
+	{
+		exit(EXIT_FAILURE);
+	}
+
+	printf("%10s %16s %16s %16s %9s %14s\n", "database", "processAll fr/s", "24B steps fr/s", "56B steps fr/s", "speedup", "printed fr/s");
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+	{
+		options.messages = sizes[s];
+		BenchAll_Measure(&options);
+	}
+
+	fclose(output);
+}
@@ -0,0 +1,120 @@
+/**
+ * @file benchExtract.c
+ *
+ * Signal extraction kernel: ns/signal of decodeRaw() compared to the
+ * byte wise extractor Support_ExtractSignal(), on the same signals and
+ * payloads, without lookups or callbacks.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "support.h"
+
+/**
+Section: Definitions
+*/
+
+#define BENCH_EXTRACT_PAYLOADS 256
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	const Dbc_Frame_t *frame;
+	struct canfd_frame frames[BENCH_EXTRACT_PAYLOADS];
+} BenchExtract_t;
+
+/**
+Section: Private functions
+*/
+
+static void BenchExtract_Steps(void *context)
+{
+	const BenchExtract_t *bench = context;
+	const Dbc_DecodeStep_t *step;
+	uint64_t sum = 0;
+	unsigned int i;
+
+	for (i = 0; i < BENCH_EXTRACT_PAYLOADS; i++)
+	{
+		for (step = bench->frame->plan; step < bench->frame->plan + bench->frame->planLength; step++)
+		{
+			sum += decodeRaw(step, bench->frames[i].data);
+		}
+	}
+	Bench_Sink += sum;
+}
+
+static void BenchExtract_Previous(void *context)
+{
+	const BenchExtract_t *bench = context;
+	const Dbc_Signal_t *signal;
+	uint64_t sum = 0;
+	unsigned int i;
+
+	for (i = 0; i < BENCH_EXTRACT_PAYLOADS; i++)
+	{
+		for (signal = bench->frame->signals; signal < bench->frame->signals + bench->frame->signalCount; signal++)
+		{
+			sum += Support_ExtractSignal(signal, bench->frames[i].data);
+		}
+	}
+	Bench_Sink += sum;
+}
+
+static void BenchExtract_Compare(const char *name, const Support_DbcOptions_t *options)
+{
+	BenchExtract_t *bench;
+	Dbc_Database_t *db;
+	uint64_t state = 1;
+	unsigned int i;
+	double steps, previous, signals;
+
+	bench = malloc(sizeof(BenchExtract_t));
+	if (NULL == bench)
+	{
+		exit(EXIT_FAILURE);
+	}
+	db = Support_Database(options);
+	bench->frame = &db->frames[0];
+	for (i = 0; i < BENCH_EXTRACT_PAYLOADS; i++)
+	{
+		Support_Frame(&state, options, 0, &bench->frames[i]);
+	}
+
+	signals = (double) BENCH_EXTRACT_PAYLOADS * bench->frame->signalCount;
+	steps = Bench_Measure(BenchExtract_Steps, bench, signals);
+	previous = Bench_Measure(BenchExtract_Previous, bench, signals);
+	printf("%-36s %12.2f %16.2f %8.2fx\n", name, steps, previous, previous / steps);
+
+	Dbc_DeInit(db);
+	free(bench);
+}
+
+/**
+Section: Implementation
+*/
+
+void BenchExtract_Run(void)
+{
+	Support_DbcOptions_t options = { 1, 8, CAN_MAX_DLEN, 0, 1 };
+
+	printf("%-36s %12s %16s %9s\n", "signals", "ns/signal", "previous ns/sig", "speedup");
+	BenchExtract_Compare("8 x 8 bit, Intel/Motorola", &options);
+	options.signals = 4;
+	BenchExtract_Compare("4 x 16 bit, Intel/Motorola", &options);
+	options.signals = 5;
+	BenchExtract_Compare("5 x 12 bit, Intel", &options);
+	options.signals = 64;
+	BenchExtract_Compare("64 x 1 bit, Intel", &options);
+	options.signals = 16;
+	options.dlc = CANFD_MAX_DLEN;
+	BenchExtract_Compare("CAN FD 16 x 32 bit, Intel/Motorola", &options);
+}
@@ -0,0 +1,101 @@
+/**
+ * @file benchFd.c
+ *
+ * CAN FD: signals/s of processAllFrames() on 64 byte payloads compared to
+ * classic 8 byte payloads with signals of the same width. Signals beyond
+ * bit 63 are read from their own 8 byte window, so the cost per signal
+ * should not depend on the payload size.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "support.h"
+
+/**
+Section: Definitions
+*/
+
+#define BENCH_FD_FRAMES 4096
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	Dbc_Database_t *db;
+	struct canfd_frame *frames;
+} BenchFd_t;
+
+/**
+Section: Private functions
+*/
+
+static void BenchFd_Decode(void *context)
+{
+	BenchFd_t *bench = context;
+	unsigned int i;
+
+	for (i = 0; i < BENCH_FD_FRAMES; i++)
+	{
+		processAllFrames(bench->db, Bench_CountCallback, &bench->frames[i], 0, "can0");
+	}
+}
+
+static void BenchFd_Measure(const Support_DbcOptions_t *options)
+{
+	BenchFd_t bench;
+	uint64_t state = 1, signals;
+	unsigned int i;
+	double ns;
+
+	bench.db = Support_Database(options);
+	bench.frames = malloc(BENCH_FD_FRAMES * sizeof(struct canfd_frame));
+	if (NULL == bench.frames)
+	{
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < BENCH_FD_FRAMES; i++)
+	{
+		Support_Frame(&state, options, Support_Random(&state) % options->messages, &bench.frames[i]);
+	}
+
+	Bench_Signals = 0;
+	BenchFd_Decode(&bench);
+	signals = Bench_Signals;
+
+	ns = Bench_Measure(BenchFd_Decode, &bench, signals);
+	printf("%8u %8u %10u %12.2f %10.1f %14.0f\n", options->dlc, options->dlc * 8 / options->signals,
+		(unsigned int) (signals / BENCH_FD_FRAMES), ns, 1e3 / ns, 1e9 / (ns * signals / BENCH_FD_FRAMES));
+
+	free(bench.frames);
+	Dbc_DeInit(bench.db);
+}
+
+/**
+Section: Implementation
+*/
+
+void BenchFd_Run(void)
+{
+	static const unsigned int widths[] = { 8, 16, 32 };
+	Support_DbcOptions_t options = { 100, 0, 0, 0, 1 };
+	unsigned int w;
+
+	printf("%8s %8s %10s %12s %10s %14s\n", "payload", "bits", "sig/fr", "ns/sig", "Msig/s", "frames/s");
+	for (w = 0; w < sizeof(widths) / sizeof(widths[0]); w++)
+	{
+		options.dlc = CAN_MAX_DLEN;
+		options.signals = CAN_MAX_DLEN * 8 / widths[w];
+		BenchFd_Measure(&options);
+
+		options.dlc = CANFD_MAX_DLEN;
+		options.signals = CANFD_MAX_DLEN * 8 / widths[w];
+		BenchFd_Measure(&options);
+	}
+}
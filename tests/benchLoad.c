@@ -0,0 +1,100 @@
+/**
+ * @file benchLoad.c
+ *
+ * Database load time for synthetic DBC files of 100, 1,000 and 10,000
+ * messages: Dbc_Init() reads and tokenizes the DBC file, DbcCache_Init()
+ * maps an up to date cache of it instead.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench.h"
+#include "support.h"
+#include "dbcCache.h"
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	char dbcPath[32];
+	char cachePath[40];
+} BenchLoad_t;
+
+/**
+Section: Private functions
+*/
+
+static void BenchLoad_Parse(void *context)
+{
+	BenchLoad_t *bench = context;
+	Dbc_Database_t *db;
+
+	if (Dbc_Init(&db, bench->dbcPath))
+	{
+		exit(EXIT_FAILURE);
+	}
+	Bench_Sink += db->frameCount;
+	Dbc_DeInit(db);
+}
+
+static void BenchLoad_Cache(void *context)
+{
+	BenchLoad_t *bench = context;
+	Dbc_Database_t *db;
+
+	if (DbcCache_Init(&db, bench->dbcPath, bench->cachePath))
+	{
+		exit(EXIT_FAILURE);
+	}
+	Bench_Sink += db->frameCount;
+	Dbc_DeInit(db);
+}
+
+/**
+Section: Implementation
+*/
+
+void BenchLoad_Run(void)
+{
+	static const unsigned int sizes[] = { 100, 1000, 10000 };
+	Support_DbcOptions_t options = { 0, 8, CAN_MAX_DLEN, 16, 1 };
+	BenchLoad_t bench;
+	double parse, cache;
+	unsigned int s;
+	size_t size;
+	char *text;
+	int fd;
+
+	printf("%10s %10s %12s %10s %10s %14s\n", "messages", "DBC kB", "Dbc_Init ms", "us/msg", "MB/s", "cache load ms");
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+	{
+		options.messages = sizes[s];
+		text = Support_Dbc(&options, &size);
+		strcpy(bench.dbcPath, "/tmp/benchLoadXXXXXX");
+		fd = mkstemp(bench.dbcPath);
+		if (NULL == text || fd < 0 || (ssize_t) size != write(fd, text, size))
+		{
+			exit(EXIT_FAILURE);
+		}
+		close(fd);
+		free(text);
+		snprintf(bench.cachePath, sizeof(bench.cachePath), "%s.cache", bench.dbcPath);
+
+		parse = Bench_Measure(BenchLoad_Parse, &bench, 1);
+		/* The first load writes the cache, the measured ones map it */
+		cache = Bench_Measure(BenchLoad_Cache, &bench, 1);
+		printf("%10u %10.0f %12.2f %10.2f %10.1f %14.3f\n", sizes[s], size / 1e3, parse / 1e6,
+			parse / 1e3 / sizes[s], size / parse * 1e3, cache / 1e6);
+
+		unlink(bench.dbcPath);
+		unlink(bench.cachePath);
+	}
+}
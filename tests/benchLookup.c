@@ -0,0 +1,106 @@
+/**
+ * @file benchLookup.c
+ *
+ * Frame lookup: the per frame cost of processAllFrames() has to stay flat
+ * while the database grows. The linear scan over all frames, which the
+ * lookup replaced, is measured for comparison.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "support.h"
+
+/**
+Section: Definitions
+*/
+
+#define BENCH_LOOKUP_FRAMES 4096
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	Dbc_Database_t *db;
+	struct canfd_frame *frames;
+} BenchLookup_t;
+
+/**
+Section: Private functions
+*/
+
+static void BenchLookup_Decode(void *context)
+{
+	BenchLookup_t *bench = context;
+	unsigned int i;
+
+	for (i = 0; i < BENCH_LOOKUP_FRAMES; i++)
+	{
+		processAllFrames(bench->db, Bench_CountCallback, &bench->frames[i], 0, "can0");
+	}
+}
+
+/* The frame search of the original processAllFrames() */
+static void BenchLookup_Scan(void *context)
+{
+	BenchLookup_t *bench = context;
+	unsigned int i, f;
+
+	for (i = 0; i < BENCH_LOOKUP_FRAMES; i++)
+	{
+		for (f = 0; f < bench->db->frameCount; f++)
+		{
+			if (bench->db->frames[f].canID == bench->frames[i].can_id)
+			{
+				Bench_Sink += f;
+				break;
+			}
+		}
+	}
+}
+
+/**
+Section: Implementation
+*/
+
+void BenchLookup_Run(void)
+{
+	static const unsigned int sizes[] = { 10, 100, 1000, 10000 };
+	Support_DbcOptions_t options = { 0, 4, CAN_MAX_DLEN, 0, 0 };
+	BenchLookup_t bench;
+	uint64_t state = 1;
+	unsigned int i, s;
+	double decode, scan;
+
+	bench.frames = malloc(BENCH_LOOKUP_FRAMES * sizeof(struct canfd_frame));
+	if (NULL == bench.frames)
+	{
+		exit(EXIT_FAILURE);
+	}
+
+	printf("%10s %14s %14s %16s\n", "messages", "decode ns/fr", "frames/s", "linear scan ns");
+	for (s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+	{
+		options.messages = sizes[s];
+		bench.db = Support_Database(&options);
+		for (i = 0; i < BENCH_LOOKUP_FRAMES; i++)
+		{
+			Support_Frame(&state, &options, Support_Random(&state) % options.messages, &bench.frames[i]);
+			bench.frames[i].can_id = Dbc_NormalizeId(bench.frames[i].can_id);
+		}
+
+		decode = Bench_Measure(BenchLookup_Decode, &bench, BENCH_LOOKUP_FRAMES);
+		scan = Bench_Measure(BenchLookup_Scan, &bench, BENCH_LOOKUP_FRAMES);
+		printf("%10u %14.1f %14.0f %16.1f\n", sizes[s], decode, 1e9 / decode, scan);
+
+		Dbc_DeInit(bench.db);
+	}
+
+	free(bench.frames);
+}
@@ -0,0 +1,116 @@
+/**
+ * @file benchParse.c
+ *
+ * Line parser: parseLine() compared to the sscanf() and parse_canframe()
+ * path it replaced, on the same synthetic candump -L log.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include "bench.h"
+#include "support.h"
+#include "parseLine.h"
+#include "lib.h"
+
+/**
+Section: Definitions
+*/
+
+#define BENCH_PARSE_LINES 65536
+#define BENCH_PARSE_LINE_SIZE 256  /**< Buffer of the original fgets() loop */
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	const char *log;
+	size_t size;
+} BenchParse_t;
+
+/**
+Section: Private functions
+*/
+
+static void BenchParse_ParseLine(void *context)
+{
+	const BenchParse_t *bench = context;
+	const char *line = bench->log, *end = bench->log + bench->size, *newline, *device;
+	struct canfd_frame cf;
+	size_t deviceLength;
+	__u64 timestamp;
+
+	while (line < end)
+	{
+		newline = memchr(line, '\n', end - line);
+		if (0 != parseLine(line, newline - line, NULL, &timestamp, &device, &deviceLength, &cf))
+		{
+			exit(EXIT_FAILURE);
+		}
+		Bench_Sink += timestamp + cf.data[0];
+		line = newline + 1;
+	}
+}
+
+/* The original loop: fgets() copies the line, which sscanf() splits and parse_canframe() converts */
+static void BenchParse_Sscanf(void *context)
+{
+	const BenchParse_t *bench = context;
+	const char *line = bench->log, *end = bench->log + bench->size, *newline;
+	char buf[BENCH_PARSE_LINE_SIZE], device[BENCH_PARSE_LINE_SIZE], ascframe[BENCH_PARSE_LINE_SIZE];
+	struct can_frame cf;
+	struct timeval tv;
+
+	while (line < end)
+	{
+		newline = memchr(line, '\n', end - line);
+		memcpy(buf, line, newline + 1 - line);
+		buf[newline + 1 - line] = '\0';
+
+		if (sscanf(buf, "(%ld.%ld) %s %s", &tv.tv_sec, &tv.tv_usec, device, ascframe) != 4 ||
+			parse_canframe(ascframe, &cf))
+		{
+			exit(EXIT_FAILURE);
+		}
+		Bench_Sink += tv.tv_sec + tv.tv_usec + cf.data[0];
+		line = newline + 1;
+	}
+}
+
+/**
+Section: Implementation
+*/
+
+void BenchParse_Run(void)
+{
+	Support_DbcOptions_t options = { 4000, 8, CAN_MAX_DLEN, 0, 0 };
+	BenchParse_t bench;
+	uint64_t state = 1;
+	char *log;
+	double single, scanned;
+
+	log = Support_Log(&state, &options, BENCH_PARSE_LINES, &bench.size);
+	if (NULL == log)
+	{
+		exit(EXIT_FAILURE);
+	}
+	bench.log = log;
+
+	single = Bench_Measure(BenchParse_ParseLine, &bench, BENCH_PARSE_LINES);
+	scanned = Bench_Measure(BenchParse_Sscanf, &bench, BENCH_PARSE_LINES);
+	printf("%-28s %10s %12s %10s\n", "parser", "ns/line", "lines/s", "MB/s");
+	printf("%-28s %10.1f %12.0f %10.1f\n", "parseLine", single, 1e9 / single,
+		bench.size / (single * BENCH_PARSE_LINES) * 1e3);
+	printf("%-28s %10.1f %12.0f %10.1f\n", "sscanf + parse_canframe", scanned, 1e9 / scanned,
+		bench.size / (scanned * BENCH_PARSE_LINES) * 1e3);
+	printf("speedup %.2fx\n", scanned / single);
+
+	free(log);
+}
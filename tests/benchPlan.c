@@ -0,0 +1,153 @@
+/**
+ * @file benchPlan.c
+ *
+ * Decode plans: signals/s of processAllFrames() compared to the decoder
+ * before the plans, which walked the signal list of the frame, extracted
+ * each signal byte by byte and computed the physical value and the value
+ * string of every signal.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "bench.h"
+#include "support.h"
+
+/**
+Section: Definitions
+*/
+
+#define BENCH_PLAN_FRAMES 4096
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	Dbc_Database_t *db;
+	struct canfd_frame *frames;
+} BenchPlan_t;
+
+/**
+Section: Private functions
+*/
+
+static void BenchPlan_Decode(void *context)
+{
+	BenchPlan_t *bench = context;
+	unsigned int i;
+
+	for (i = 0; i < BENCH_PLAN_FRAMES; i++)
+	{
+		processAllFrames(bench->db, Bench_CountCallback, &bench->frames[i], 0, "can0");
+	}
+}
+
+static void BenchPlan_DecodeSignal(const Dbc_Signal_t *signal, const __u8 *data)
+{
+	__u64 raw = Support_ExtractSignal(signal, data);
+	double value = signal->is_signed ? (double) (__s64) raw : (double) raw;
+
+	Bench_Sink += (uint64_t) (value * signal->factor + signal->offset);
+	Bench_Sink += (uintptr_t) Dbc_FindValueString(signal, raw);
+	Bench_Signals++;
+}
+
+/* The signal walk of the original processAllFrames() */
+static void BenchPlan_Walk(void *context)
+{
+	BenchPlan_t *bench = context;
+	const Dbc_Frame_t *frame;
+	const Dbc_Signal_t *signal;
+	__u64 muxerVal = 0;
+	unsigned int i;
+
+	for (i = 0; i < BENCH_PLAN_FRAMES; i++)
+	{
+		frame = Dbc_FindFrame(bench->db, bench->frames[i].can_id);
+		for (signal = frame->signals; signal < frame->signals + frame->signalCount; signal++)
+		{
+			if (DBC_MUX_DEFINE == signal->isMultiplexer)
+			{
+				muxerVal = Support_ExtractSignal(signal, bench->frames[i].data);
+				BenchPlan_DecodeSignal(signal, bench->frames[i].data);
+				break;
+			}
+		}
+		for (signal = frame->signals; signal < frame->signals + frame->signalCount; signal++)
+		{
+			if (DBC_MUX_NONE == signal->isMultiplexer || (DBC_MUX_DATA == signal->isMultiplexer && signal->muxId == muxerVal))
+			{
+				BenchPlan_DecodeSignal(signal, bench->frames[i].data);
+			}
+		}
+	}
+}
+
+static void BenchPlan_Compare(const char *name, Dbc_Database_t *db)
+{
+	BenchPlan_t bench;
+	const Dbc_Frame_t *frame;
+	uint64_t state = 1, signals;
+	unsigned int i, j;
+	double plan, walk;
+
+	bench.db = db;
+	bench.frames = calloc(BENCH_PLAN_FRAMES, sizeof(struct canfd_frame));
+	if (NULL == bench.frames)
+	{
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0; i < BENCH_PLAN_FRAMES; i++)
+	{
+		frame = &db->frames[Support_Random(&state) % db->frameCount];
+		bench.frames[i].can_id = frame->canID;
+		bench.frames[i].len = frame->dlc;
+		for (j = 0; j < frame->dlc; j++)
+		{
+			bench.frames[i].data[j] = Support_Random(&state);
+		}
+	}
+
+	/* Both decode the same signals */
+	Bench_Signals = 0;
+	BenchPlan_Decode(&bench);
+	signals = Bench_Signals;
+
+	plan = Bench_Measure(BenchPlan_Decode, &bench, signals);
+	walk = Bench_Measure(BenchPlan_Walk, &bench, signals);
+	printf("%-28s %8.1f %12.1f %10.1f %12.1f %8.2fx\n", name, (double) signals / BENCH_PLAN_FRAMES,
+		plan, 1e3 / plan, walk, walk / plan);
+
+	free(bench.frames);
+}
+
+/**
+Section: Implementation
+*/
+
+void BenchPlan_Run(void)
+{
+	Support_DbcOptions_t options = { 1000, 8, CAN_MAX_DLEN, 16, 1 };
+	Dbc_Database_t *db;
+
+	printf("%-28s %8s %12s %10s %12s %9s\n", "database", "sig/fr", "plan ns/sig", "Msig/s", "walk ns/sig", "speedup");
+	if (0 == Dbc_Init(&db, "ccl_test.dbc"))
+	{
+		BenchPlan_Compare("ccl_test.dbc", db);
+		Dbc_DeInit(db);
+	}
+
+	db = Support_Database(&options);
+	BenchPlan_Compare("1000 messages x 8 signals", db);
+	Dbc_DeInit(db);
+
+	options.signals = 32;
+	db = Support_Database(&options);
+	BenchPlan_Compare("1000 messages x 32 signals", db);
+	Dbc_DeInit(db);
+}
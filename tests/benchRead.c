@@ -0,0 +1,225 @@
+/**
+ * @file benchRead.c
+ *
+ * Log input: frames/s read from a candump -L file with the LineReader and
+ * with the getline() loop it replaced, both with and without parsing the
+ * lines, and from the same frames converted to a frame log, which is
+ * mapped and not parsed at all. The files are read from the page cache.
+ */
+
+/**
+Section: Included Files
+*/
+
+#define _GNU_SOURCE  /* getline() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "bench.h"
+#include "support.h"
+#include "parseLine.h"
+#include "lineReader.h"
+#include "frameLog.h"
+
+/**
+Section: Definitions
+*/
+
+#define BENCH_READ_FRAMES (1 << 18)
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	char textPath[32];
+	char logPath[32];
+	int parse;  /**< Parse the lines, not just find them */
+} BenchRead_t;
+
+/**
+Section: Private functions
+*/
+
+static void BenchRead_Line(const BenchRead_t *bench, const char *line, size_t length)
+{
+	const char *device;
+	struct canfd_frame cf;
+	size_t deviceLength;
+	__u64 timestamp;
+
+	if (!bench->parse)
+	{
+		Bench_Sink += length;
+	}
+	else if (0 == parseLine(line, length, NULL, &timestamp, &device, &deviceLength, &cf))
+	{
+		Bench_Sink += timestamp + cf.data[0];
+	}
+	else
+	{
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void BenchRead_LineReader(void *context)
+{
+	const BenchRead_t *bench = context;
+	LineReader_t reader;
+	char *line;
+	size_t length;
+	int fd;
+
+	fd = open(bench->textPath, O_RDONLY);
+	if (fd < 0 || LineReader_Init(&reader, fd, LINE_READER_BLOCK_SIZE))
+	{
+		exit(EXIT_FAILURE);
+	}
+	while (LineReader_Next(&reader, &line, &length) > 0)
+	{
+		BenchRead_Line(bench, line, length);
+	}
+	LineReader_DeInit(&reader);
+	close(fd);
+}
+
+/* The stdio loop the LineReader replaced */
+static void BenchRead_Getline(void *context)
+{
+	const BenchRead_t *bench = context;
+	char *line = NULL;
+	size_t size = 0;
+	ssize_t length;
+	FILE *fp;
+
+	fp = fopen(bench->textPath, "r");
+	if (NULL == fp)
+	{
+		exit(EXIT_FAILURE);
+	}
+	while ((length = getline(&line, &size, fp)) > 0)
+	{
+		if ('\n' == line[length - 1])
+		{
+			length--;
+		}
+		BenchRead_Line(bench, line, length);
+	}
+	free(line);
+	fclose(fp);
+}
+
+static void BenchRead_Frame(const struct canfd_frame *cf, __u64 timestamp, char *device, void *context)
+{
+	(void) device;
+	(void) context;
+
+	Bench_Sink += timestamp + cf->data[0];
+}
+
+static void BenchRead_FrameLog(void *context)
+{
+	const BenchRead_t *bench = context;
+
+	if (FrameLog_ProcessFile(bench->logPath, BenchRead_Frame, NULL))
+	{
+		exit(EXIT_FAILURE);
+	}
+}
+
+/* Writes the synthetic log as text and as frame log */
+static void BenchRead_WriteFiles(BenchRead_t *bench)
+{
+	Support_DbcOptions_t options = { 4000, 8, CAN_MAX_DLEN, 0, 0 };
+	const char *line, *end, *newline, *device;
+	char name[IF_NAMESIZE];
+	FrameLog_Writer_t writer;
+	struct canfd_frame cf;
+	size_t size, deviceLength;
+	uint64_t state = 1;
+	__u64 timestamp;
+	char *log;
+	int fd;
+
+	log = Support_Log(&state, &options, BENCH_READ_FRAMES, &size);
+	strcpy(bench->textPath, "/tmp/benchReadXXXXXX");
+	strcpy(bench->logPath, "/tmp/benchReadXXXXXX");
+	fd = mkstemp(bench->textPath);
+	if (NULL == log || fd < 0 || (ssize_t) size != write(fd, log, size))
+	{
+		exit(EXIT_FAILURE);
+	}
+	close(fd);
+	fd = mkstemp(bench->logPath);
+	if (fd < 0 || FrameLog_Create(&writer, bench->logPath))
+	{
+		exit(EXIT_FAILURE);
+	}
+	close(fd);
+
+	for (line = log, end = log + size; line < end; line = newline + 1)
+	{
+		newline = memchr(line, '\n', end - line);
+		if (parseLine(line, newline - line, NULL, &timestamp, &device, &deviceLength, &cf) || deviceLength >= IF_NAMESIZE)
+		{
+			exit(EXIT_FAILURE);
+		}
+		memcpy(name, device, deviceLength);
+		name[deviceLength] = '\0';
+		if (FrameLog_Write(&writer, &cf, timestamp, name))
+		{
+			exit(EXIT_FAILURE);
+		}
+	}
+	if (FrameLog_Close(&writer))
+	{
+		exit(EXIT_FAILURE);
+	}
+	free(log);
+}
+
+static void BenchRead_Print(const char *name, const char *path, double ns)
+{
+	struct stat st;
+
+	if (stat(path, &st))
+	{
+		exit(EXIT_FAILURE);
+	}
+	printf("%-28s %10.1f %12.0f %10.1f\n", name, ns, 1e9 / ns, st.st_size / (ns * BENCH_READ_FRAMES) * 1e3);
+}
+
+/**
+Section: Implementation
+*/
+
+void BenchRead_Run(void)
+{
+	BenchRead_t bench;
+	double ns;
+
+	BenchRead_WriteFiles(&bench);
+
+	printf("%-28s %10s %12s %10s\n", "input", "ns/frame", "frames/s", "MB/s");
+	bench.parse = 0;
+	ns = Bench_Measure(BenchRead_Getline, &bench, BENCH_READ_FRAMES);
+	BenchRead_Print("getline", bench.textPath, ns);
+	ns = Bench_Measure(BenchRead_LineReader, &bench, BENCH_READ_FRAMES);
+	BenchRead_Print("LineReader", bench.textPath, ns);
+
+	bench.parse = 1;
+	ns = Bench_Measure(BenchRead_Getline, &bench, BENCH_READ_FRAMES);
+	BenchRead_Print("getline + parseLine", bench.textPath, ns);
+	ns = Bench_Measure(BenchRead_LineReader, &bench, BENCH_READ_FRAMES);
+	BenchRead_Print("LineReader + parseLine", bench.textPath, ns);
+
+	ns = Bench_Measure(BenchRead_FrameLog, &bench, BENCH_READ_FRAMES);
+	BenchRead_Print("frame log", bench.logPath, ns);
+
+	unlink(bench.textPath);
+	unlink(bench.logPath);
+}
@@ -0,0 +1,209 @@
+/**
+ * @file support.c
+ *
+ * Synthetic DBC files, logs and frames for the tests and benchmarks
+ */
+
+/**
+Section: Included Files
+*/
+
+#define _GNU_SOURCE  /* open_memstream() */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "support.h"
+
+/**
+Section: Private functions
+*/
+
+static unsigned int Support_SignalWidth(const Support_DbcOptions_t *options)
+{
+	unsigned int width = options->dlc * 8 / options->signals;
+
+	return (width > 64) ? 64 : (width < 1) ? 1 : width;
+}
+
+/**
+Section: Implementation
+*/
+
+uint64_t Support_Random(uint64_t *state)
+{
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+
+	return *state * 0x2545F4914F6CDD1DULL;
+}
+
+canid_t Support_MessageId(unsigned int message)
+{
+	if (message < CAN_SFF_MASK)
+	{
+		return message + 1;
+	}
+
+	return CAN_EFF_FLAG | (0x10000 + message);
+}
+
+char *Support_Dbc(const Support_DbcOptions_t *options, size_t *size)
+{
+	static const char *scaling[] = { "(1,0)", "(2,0)", "(0.5,-3)" };
+	unsigned int width = Support_SignalWidth(options);
+	unsigned int m, s, v, start;
+	char *text = NULL;
+	FILE *fp;
+
+	fp = open_memstream(&text, size);
+	if (NULL == fp)
+	{
+		return NULL;
+	}
+
+	fprintf(fp, "VERSION \"\"\n\nNS_ :\n\nBS_:\n\nBU_: ECU RX\n\n");
+	for (m = 0; m < options->messages; m++)
+	{
+		fprintf(fp, "BO_ %u Msg%u: %u ECU\n", Support_MessageId(m), m, options->dlc);
+		for (s = 0; s < options->signals; s++)
+		{
+			start = s * width;
+			if (options->motorola && (s & 1) && 0 == width % 8 && 0 == start % 8)
+			{
+				/* Motorola start bits are the MSB, which is bit 7 of the first byte */
+				fprintf(fp, " SG_ Sig%u_%u : %u|%u@0%c %s [0|0] \"u%u\" RX\n", m, s, start + 7, width,
+					(s & 1) ? '-' : '+', scaling[s % 3], s % 4);
+			}
+			else
+			{
+				fprintf(fp, " SG_ Sig%u_%u : %u|%u@1%c %s [0|0] \"u%u\" RX\n", m, s, start, width,
+					(s & 1) ? '-' : '+', scaling[s % 3], s % 4);
+			}
+		}
+		fprintf(fp, "\n");
+	}
+	for (m = 0; options->values > 0 && m < options->messages; m++)
+	{
+		fprintf(fp, "VAL_ %u Sig%u_0", Support_MessageId(m), m);
+		for (v = 0; v < options->values; v++)
+		{
+			fprintf(fp, " %u \"State%u\"", v, v);
+		}
+		fprintf(fp, " ;\n");
+	}
+
+	if (0 != fclose(fp))
+	{
+		free(text);
+		return NULL;
+	}
+
+	return text;
+}
+
+Dbc_Database_t *Support_Database(const Support_DbcOptions_t *options)
+{
+	Dbc_Database_t *db;
+	char *text;
+	size_t size;
+
+	text = Support_Dbc(options, &size);
+	if (NULL == text || 0 != Dbc_Parse(&db, text, size))
+	{
+		fprintf(stderr, "Unable to build a synthetic database\n");
+		exit(EXIT_FAILURE);
+	}
+	free(text);
+
+	return db;
+}
+
+void Support_Frame(uint64_t *state, const Support_DbcOptions_t *options, unsigned int message, struct canfd_frame *cf)
+{
+	uint64_t word;
+	unsigned int i;
+
+	memset(cf, 0, sizeof(*cf));
+	cf->can_id = Support_MessageId(message);
+	cf->len = options->dlc;
+	for (i = 0; i < options->dlc; i += sizeof(word))
+	{
+		word = Support_Random(state);
+		memcpy(&cf->data[i], &word, sizeof(word));
+	}
+}
+
+char *Support_Log(uint64_t *state, const Support_DbcOptions_t *options, unsigned int frames, size_t *size)
+{
+	static const char hexDigits[] = "0123456789ABCDEF";
+	struct canfd_frame cf;
+	char data[2 * CANFD_MAX_DLEN + 1];
+	char *text = NULL;
+	unsigned int i, j;
+	FILE *fp;
+
+	fp = open_memstream(&text, size);
+	if (NULL == fp)
+	{
+		return NULL;
+	}
+
+	for (i = 0; i < frames; i++)
+	{
+		Support_Frame(state, options, Support_Random(state) % options->messages, &cf);
+		for (j = 0; j < cf.len; j++)
+		{
+			data[2 * j] = hexDigits[cf.data[j] >> 4];
+			data[2 * j + 1] = hexDigits[cf.data[j] & 0x0F];
+		}
+		data[2 * cf.len] = '\0';
+
+		fprintf(fp, "(%u.%06u) can0 ", i / 1000, i % 1000);
+		if (cf.can_id & CAN_EFF_FLAG)
+			fprintf(fp, "%08X", cf.can_id & CAN_EFF_MASK);
+		else
+			fprintf(fp, "%03X", cf.can_id);
+		fprintf(fp, (cf.len > CAN_MAX_DLEN) ? "##0%s\n" : "#%s\n", data);
+	}
+
+	if (0 != fclose(fp))
+	{
+		free(text);
+		return NULL;
+	}
+
+	return text;
+}
+
+__u64 Support_ExtractSignal(const Dbc_Signal_t *signal, const __u8 *data)
+{
+	__u64 raw = 0, mask, signMask;
+	int firstByte, lastByte, i;
+
+	/* startBit is the LSB position for both byte orders (see Dbc_ProcessStartBit) */
+	if (signal->is_big_endian)
+	{
+		lastByte = signal->startBit / 8;
+		firstByte = lastByte - (signal->startBit % 8 + signal->signalLength - 1) / 8;
+		for (i = firstByte; i <= lastByte; i++)
+		{
+			raw = (raw << 8) | data[i];
+		}
+	}
+	else
+	{
+		firstByte = signal->startBit / 8;
+		lastByte = (signal->startBit + signal->signalLength - 1) / 8;
+		for (i = lastByte; i >= firstByte; i--)
+		{
+			raw = (raw << 8) | data[i];
+		}
+	}
+
+	mask = (signal->signalLength < 64) ? ((1ULL << signal->signalLength) - 1) : ~0ULL;
+	signMask = signal->is_signed ? (1ULL << (signal->signalLength - 1)) : 0;
+	raw = (raw >> (signal->startBit % 8)) & mask;
+
+	return (raw ^ signMask) - signMask;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file support.h
+ *
+ * Synthetic DBC files, logs and frames for the tests and benchmarks
+ */
+
+#ifndef _SUPPORT_H_
+#define _SUPPORT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <linux/can.h>
+#include "dbc.h"
+
+/**
+Section: Public Types
+*/
+
+/**
+ * Shape of a synthetic database. Message m is called Msgm and has the
+ * signals Sigm_0 .. Sigm_(signals - 1), which split the payload into equal
+ * bit fields. The signals cycle through unsigned/signed and identity,
+ * integer and general scaling.
+ */
+typedef struct
+{
+	unsigned int messages;
+	unsigned int signals;  /**< Per message, at least 1 */
+	unsigned int dlc;      /**< Payload bytes, 8 or 64 */
+	unsigned int values;   /**< VAL_ entries of the first signal of each message, 0 for none */
+	int motorola;          /**< Every other byte aligned signal is Motorola */
+} Support_DbcOptions_t;
+
+/**
+Section: Public Function Declarations
+*/
+
+/**
+ * @brief      Returns a pseudo random number (xorshift64*)
+ *
+ * @param      state  The generator state, not 0
+ *
+ * @return     The number
+ */
+uint64_t Support_Random(uint64_t *state);
+
+/**
+ * @brief      Returns the SocketCAN ID of a synthetic message
+ *
+ * The first 0x7FF messages have standard IDs, the others extended IDs. The
+ * ID is also the BO_ ID, as both use bit 31 for extended IDs.
+ *
+ * @param[in]  message  The message number
+ *
+ * @return     The ID
+ */
+canid_t Support_MessageId(unsigned int message);
+
+/**
+ * @brief      Writes a synthetic DBC file into memory
+ *
+ * @param[in]  options  The shape of the database
+ * @param[out] size     Length of the text
+ *
+ * @return     The NUL terminated text (to be freed by the caller) or NULL if out of memory
+ */
+char *Support_Dbc(const Support_DbcOptions_t *options, size_t *size);
+
+/**
+ * @brief      Parses a synthetic DBC file
+ *
+ * @param[in]  options  The shape of the database
+ *
+ * @return     The database (to be freed by Dbc_DeInit()); exits on errors
+ */
+Dbc_Database_t *Support_Database(const Support_DbcOptions_t *options);
+
+/**
+ * @brief      Fills a frame of a synthetic message with a random payload
+ *
+ * @param      state    The generator state
+ * @param[in]  options  The shape of the database
+ * @param[in]  message  The message number
+ * @param[out] cf       The frame, bytes behind the payload are zeroed
+ */
+void Support_Frame(uint64_t *state, const Support_DbcOptions_t *options, unsigned int message, struct canfd_frame *cf);
+
+/**
+ * @brief      Writes a candump -L log of random frames of random messages into memory
+ *
+ * @param      state    The generator state
+ * @param[in]  options  The shape of the database
+ * @param[in]  frames   Number of frames
+ * @param[out] size     Length of the text
+ *
+ * @return     The text (to be freed by the caller) or NULL if out of memory
+ */
+char *Support_Log(uint64_t *state, const Support_DbcOptions_t *options, unsigned int frames, size_t *size);
+
+/**
+ * @brief      Extracts the raw value of a signal byte wise, without a decode plan
+ *
+ * The bytes spanned by the signal are assembled in signal byte order, then
+ * shifted, masked and sign extended. Stands in for extractSignal() of
+ * libcan-encode-decode, whose sources are not part of this tree, as the
+ * baseline of the benchmarks.
+ *
+ * @param[in]  signal  The signal, spanning at most 8 bytes
+ * @param[in]  data    The payload
+ *
+ * @return     The raw value, sign extended for signed signals
+ */
+__u64 Support_ExtractSignal(const Dbc_Signal_t *signal, const __u8 *data);
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file synthDbc.c
+ *
+ * Writes the synthetic DBC files and candump -L logs of the tests and
+ * benchmarks, for measurements with candecode itself:
+ *
+ *   build/synthDbc -m 10000 > big.dbc
+ *   build/synthDbc -m 10000 -l 1000000 > big.log
+ *   ./candecode big.dbc all < big.log
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "support.h"
+
+/**
+Section: Private functions
+*/
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-m messages] [-s signals] [-d dlc] [-v values] [-M] [-l frames] > output\n", name);
+	fprintf(stderr, "  -m messages  messages of the DBC (default 1000)\n");
+	fprintf(stderr, "  -s signals   signals per message, splitting the payload evenly (default 8)\n");
+	fprintf(stderr, "  -d dlc       payload bytes, 8 or 64 (default 8)\n");
+	fprintf(stderr, "  -v values    VAL_ entries of the first signal of each message (default 0)\n");
+	fprintf(stderr, "  -M           make every other byte aligned signal Motorola\n");
+	fprintf(stderr, "  -l frames    write a log of random frames of the same DBC instead of the DBC\n");
+}
+
+/**
+Section: Implementation
+*/
+
+int main(int argc, char **argv)
+{
+	Support_DbcOptions_t options = { 1000, 8, CAN_MAX_DLEN, 0, 0 };
+	unsigned int frames = 0;
+	uint64_t state = 1;
+	char *text;
+	size_t size;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "m:s:d:v:Ml:")) != -1)
+	{
+		switch (opt)
+		{
+		case 'm':
+			options.messages = strtoul(optarg, NULL, 0);
+			break;
+		case 's':
+			options.signals = strtoul(optarg, NULL, 0);
+			break;
+		case 'd':
+			options.dlc = strtoul(optarg, NULL, 0);
+			break;
+		case 'v':
+			options.values = strtoul(optarg, NULL, 0);
+			break;
+		case 'M':
+			options.motorola = 1;
+			break;
+		case 'l':
+			frames = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+	if (optind != argc || 0 == options.messages || 0 == options.signals ||
+		(CAN_MAX_DLEN != options.dlc && CANFD_MAX_DLEN != options.dlc))
+	{
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	text = (frames > 0) ? Support_Log(&state, &options, frames, &size) : Support_Dbc(&options, &size);
+	if (NULL == text || size != fwrite(text, 1, size, stdout) || fflush(stdout))
+	{
+		perror("[ERROR] Unable to write the output");
+		return EXIT_FAILURE;
+	}
+	free(text);
+
+	return EXIT_SUCCESS;
+}
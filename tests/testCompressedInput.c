@@ -0,0 +1,221 @@
+/**
+ * @file testCompressedInput.c
+ *
+ * Compressed logs with lines longer than the decompression buffers: every
+ * line has to reach the handler whole and unchanged, also when a long line
+ * follows a buffer that already had to grow.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include "compressedInput.h"
+
+/**
+Section: Definitions
+*/
+
+#define TEST_COMPRESSED_LINES 6
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	size_t lengths[TEST_COMPRESSED_LINES];
+	unsigned int count;  /**< Lines seen by the handler */
+	unsigned int failures;
+} TestCompressed_t;
+
+/**
+Section: Private data
+*/
+
+/* Longer than COMPRESSED_INPUT_BUFFER_SIZE and growing, then short lines; the last one has no line end */
+static const size_t lineLengths[TEST_COMPRESSED_LINES] = { 2500000, 3000000, 10, 0, 5000000, 7 };
+
+/**
+Section: Private functions
+*/
+
+/* Line i consists of the letter 'a' + i */
+static char *TestCompressed_Text(size_t *size)
+{
+	unsigned int i;
+	char *text, *p;
+
+	*size = 0;
+	for (i = 0; i < TEST_COMPRESSED_LINES; i++)
+	{
+		*size += lineLengths[i] + 1;
+	}
+	(*size)--;
+
+	text = malloc(*size);
+	if (NULL == text)
+	{
+		exit(EXIT_FAILURE);
+	}
+	for (i = 0, p = text; i < TEST_COMPRESSED_LINES; i++)
+	{
+		memset(p, 'a' + i, lineLengths[i]);
+		p += lineLengths[i];
+		if (i + 1 < TEST_COMPRESSED_LINES)
+		{
+			*p++ = '\n';
+		}
+	}
+
+	return text;
+}
+
+/* ChunkHandler_t checking the lines of a buffer */
+static int TestCompressed_Handler(const char *data, size_t length, FILE *output, void *context)
+{
+	TestCompressed_t *test = context;
+	const char *end = data + length, *newline;
+	size_t i;
+
+	(void) output;
+	while (data < end)
+	{
+		newline = memchr(data, '\n', end - data);
+		if (NULL == newline)
+		{
+			newline = end;
+		}
+		if (test->count < TEST_COMPRESSED_LINES)
+		{
+			test->lengths[test->count] = newline - data;
+			for (i = 0; i < (size_t) (newline - data); i++)
+			{
+				if (data[i] != (char) ('a' + test->count))
+				{
+					test->failures++;
+					break;
+				}
+			}
+		}
+		test->count++;
+		data = newline + 1;
+	}
+
+	return 0;
+}
+
+static unsigned int TestCompressed_Check(const char *name, const char *path)
+{
+	TestCompressed_t test;
+	unsigned int i, failures;
+
+	memset(&test, 0, sizeof(test));
+	if (CompressedInput_ProcessFile(path, TestCompressed_Handler, &test, NULL))
+	{
+		fprintf(stderr, "FAIL: %s: unable to read %s\n", name, path);
+		return 1;
+	}
+
+	failures = test.failures + (TEST_COMPRESSED_LINES != test.count);
+	for (i = 0; i < TEST_COMPRESSED_LINES && i < test.count; i++)
+	{
+		if (test.lengths[i] != lineLengths[i])
+		{
+			fprintf(stderr, "FAIL: %s: line %u has %zu bytes, expected %zu\n", name, i, test.lengths[i], lineLengths[i]);
+			failures++;
+		}
+	}
+	printf("testCompressedInput: %s: %u lines, %u failures\n", name, test.count, failures);
+
+	return failures;
+}
+
+#ifdef HAVE_ZLIB
+static unsigned int TestCompressed_Gzip(const char *text, size_t size)
+{
+	char path[] = "/tmp/testCompressedXXXXXX";
+	unsigned int failures = 1;
+	gzFile gz;
+	int fd;
+
+	fd = mkstemp(path);
+	if (fd < 0 || NULL == (gz = gzdopen(fd, "wb")))
+	{
+		fprintf(stderr, "FAIL: gzip: unable to create %s\n", path);
+		return 1;
+	}
+	if ((int) size == gzwrite(gz, text, size) && Z_OK == gzclose(gz))
+	{
+		failures = TestCompressed_Check("gzip", path);
+	}
+	unlink(path);
+
+	return failures;
+}
+#endif
+
+#ifdef HAVE_ZSTD
+static unsigned int TestCompressed_Zstd(const char *text, size_t size)
+{
+	char path[] = "/tmp/testCompressedXXXXXX";
+	unsigned int failures = 1;
+	size_t compressedSize;
+	void *compressed;
+	int fd;
+
+	compressed = malloc(ZSTD_compressBound(size));
+	fd = mkstemp(path);
+	if (NULL == compressed || fd < 0)
+	{
+		fprintf(stderr, "FAIL: zstd: unable to create %s\n", path);
+		exit(EXIT_FAILURE);
+	}
+	compressedSize = ZSTD_compress(compressed, ZSTD_compressBound(size), text, size, 1);
+	if (!ZSTD_isError(compressedSize) && (ssize_t) compressedSize == write(fd, compressed, compressedSize))
+	{
+		failures = TestCompressed_Check("zstd", path);
+	}
+	close(fd);
+	unlink(path);
+	free(compressed);
+
+	return failures;
+}
+#endif
+
+/**
+Section: Implementation
+*/
+
+int main(void)
+{
+	unsigned int failures = 0;
+	size_t size;
+	char *text;
+
+	text = TestCompressed_Text(&size);
+#ifdef HAVE_ZLIB
+	failures += TestCompressed_Gzip(text, size);
+#else
+	printf("testCompressedInput: gzip: not supported by this build\n");
+#endif
+#ifdef HAVE_ZSTD
+	failures += TestCompressed_Zstd(text, size);
+#else
+	printf("testCompressedInput: zstd: not supported by this build\n");
+#endif
+	free(text);
+
+	return (0 == failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
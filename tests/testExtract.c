@@ -0,0 +1,242 @@
+/**
+ * @file testExtract.c
+ *
+ * Exhaustive check of the signal extraction kernel: every start bit, length,
+ * byte order and signedness of classic and CAN FD frames is compiled from a
+ * DBC and decoded with decodeRaw(). The result has to match a bit by bit
+ * reference that follows the DBC definition and the byte wise extractor of
+ * the benchmarks (Support_ExtractSignal()), and a signal has to be rejected
+ * exactly if it doesn't fit into an 8 byte window of the payload.
+ *
+ * extractSignal() of libcan-encode-decode, which decoded the signals before
+ * the decode plans, can't be compared against: the library was a git
+ * submodule whose sources were never part of this tree. The bit by bit
+ * reference stands in for it.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "processFrame.h"
+#include "support.h"
+
+/**
+Section: Definitions
+*/
+
+#define TEST_EXTRACT_PAYLOADS 8  /**< Payloads decoded per signal */
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	unsigned int startBit;  /**< As written in the DBC */
+	unsigned int length;
+	int motorola;
+	int is_signed;
+} TestExtract_Signal_t;
+
+/**
+Section: Private functions
+*/
+
+static TestExtract_Signal_t TestExtract_Signal(unsigned int signal, unsigned int payloadBits)
+{
+	TestExtract_Signal_t s;
+
+	s.is_signed = signal & 1;
+	s.motorola = (signal >> 1) & 1;
+	s.length = (signal >> 2) % 64 + 1;
+	s.startBit = (signal >> 2) / 64 % payloadBits;
+
+	return s;
+}
+
+/**
+ * @brief      Extracts a signal bit by bit as defined by the DBC format
+ *
+ * Intel signals start at their LSB and continue with the next higher bit.
+ * Motorola signals start at their MSB and continue with the next lower bit,
+ * from bit 0 of a byte to bit 7 of the next byte.
+ *
+ * @param[in]  s            The signal
+ * @param[in]  data         The payload
+ * @param[in]  payloadBits  Size of the payload
+ * @param[out] raw          The raw value, sign extended for signed signals
+ *
+ * @return     1 if the signal fits into an 8 byte window of the payload, 0 otherwise
+ */
+static int TestExtract_Reference(const TestExtract_Signal_t *s, const __u8 *data, unsigned int payloadBits, __u64 *raw)
+{
+	unsigned int i, bit = s->startBit, firstByte = s->startBit / 8, lastByte = s->startBit / 8;
+	__u64 value = 0;
+
+	for (i = 0; i < s->length; i++)
+	{
+		if (bit >= payloadBits)
+		{
+			return 0;
+		}
+		firstByte = (bit / 8 < firstByte) ? bit / 8 : firstByte;
+		lastByte = (bit / 8 > lastByte) ? bit / 8 : lastByte;
+
+		if (s->motorola)
+		{
+			value = (value << 1) | ((data[bit / 8] >> (bit % 8)) & 1);
+			bit = (0 == bit % 8) ? bit + 15 : bit - 1;
+		}
+		else
+		{
+			value |= (__u64) ((data[bit / 8] >> (bit % 8)) & 1) << i;
+			bit++;
+		}
+	}
+	if (lastByte - firstByte >= 8)
+	{
+		return 0;
+	}
+
+	if (s->is_signed && s->length < 64 && (value >> (s->length - 1)) & 1)
+	{
+		value |= ~0ULL << s->length;
+	}
+	*raw = value;
+
+	return 1;
+}
+
+/* Parses a DBC without printing the warnings about signals that don't fit */
+static Dbc_Database_t *TestExtract_Parse(const char *text, size_t size)
+{
+	Dbc_Database_t *db;
+	int savedStderr, devNull, ret;
+
+	fflush(stderr);
+	savedStderr = dup(STDERR_FILENO);
+	devNull = open("/dev/null", O_WRONLY);
+	dup2(devNull, STDERR_FILENO);
+	close(devNull);
+
+	ret = Dbc_Parse(&db, text, size);
+
+	fflush(stderr);
+	dup2(savedStderr, STDERR_FILENO);
+	close(savedStderr);
+
+	return (0 == ret) ? db : NULL;
+}
+
+static unsigned int TestExtract_Run(unsigned int payloadBytes, uint64_t *state)
+{
+	unsigned int payloadBits = payloadBytes * 8, count = payloadBits * 64 * 4;
+	unsigned int i, p, failures = 0, decodable = 0;
+	TestExtract_Signal_t s;
+	Dbc_Database_t *db;
+	Dbc_Frame_t *frame;
+	Dbc_DecodeStep_t *step;
+	__u8 data[CANFD_MAX_DLEN];
+	__u64 expected, decoded, byteWise;
+	char *text = NULL;
+	size_t size;
+	FILE *fp;
+	int fits;
+
+	/* One frame with a single signal per combination */
+	fp = open_memstream(&text, &size);
+	for (i = 0; NULL != fp && i < count; i++)
+	{
+		s = TestExtract_Signal(i, payloadBits);
+		fprintf(fp, "BO_ %u F%u: %u ECU\n SG_ S : %u|%u@%c%c (1,0) [0|0] \"\" RX\n\n", Support_MessageId(i), i, payloadBytes,
+			s.startBit, s.length, s.motorola ? '0' : '1', s.is_signed ? '-' : '+');
+	}
+	if (NULL == fp || 0 != fclose(fp) || NULL == (db = TestExtract_Parse(text, size)))
+	{
+		fprintf(stderr, "FAIL: unable to build the database\n");
+		exit(EXIT_FAILURE);
+	}
+	free(text);
+
+	for (i = 0; i < count; i++)
+	{
+		s = TestExtract_Signal(i, payloadBits);
+		frame = Dbc_FindFrame(db, Support_MessageId(i));
+		step = (NULL != frame && 1 == frame->signalCount) ? Dbc_FindDecodeStep(frame, &frame->signals[0]) : NULL;
+
+		memset(data, 0, sizeof(data));
+		fits = TestExtract_Reference(&s, data, payloadBits, &expected);
+		if (fits != (NULL != step))
+		{
+			if (failures++ < 10)
+				fprintf(stderr, "FAIL: %u|%u@%d%c in %u bytes: %s\n", s.startBit, s.length, !s.motorola, s.is_signed ? '-' : '+',
+					payloadBytes, fits ? "rejected" : "accepted");
+			continue;
+		}
+		if (NULL == step)
+		{
+			continue;
+		}
+		decodable++;
+
+		/* Random payloads, all ones and alternating bits */
+		for (p = 0; p < TEST_EXTRACT_PAYLOADS; p++)
+		{
+			switch (p)
+			{
+			case 0:
+				memset(data, 0xFF, payloadBytes);
+				break;
+			case 1:
+				memset(data, 0x55, payloadBytes);
+				break;
+			case 2:
+				memset(data, 0xAA, payloadBytes);
+				break;
+			default:
+				for (size = 0; size < payloadBytes; size++)
+				{
+					data[size] = Support_Random(state);
+				}
+				break;
+			}
+
+			TestExtract_Reference(&s, data, payloadBits, &expected);
+			decoded = decodeRaw(step, data);
+			byteWise = Support_ExtractSignal(&frame->signals[0], data);
+			if (decoded != expected || byteWise != expected)
+			{
+				if (failures++ < 10)
+					fprintf(stderr, "FAIL: %u|%u@%d%c in %u bytes: decoded 0x%llx, byte wise 0x%llx, expected 0x%llx\n",
+						s.startBit, s.length, !s.motorola, s.is_signed ? '-' : '+', payloadBytes,
+						decoded, byteWise, expected);
+			}
+		}
+	}
+
+	printf("testExtract: %u byte payloads: %u signals, %u decodable, %u failures\n", payloadBytes, count, decodable, failures);
+	Dbc_DeInit(db);
+
+	return failures;
+}
+
+/**
+Section: Implementation
+*/
+
+int main(void)
+{
+	uint64_t state = 1;
+	unsigned int failures;
+
+	failures = TestExtract_Run(CAN_MAX_DLEN, &state);
+	failures += TestExtract_Run(CANFD_MAX_DLEN, &state);
+
+	return (0 == failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
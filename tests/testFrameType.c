@@ -0,0 +1,133 @@
+/**
+ * @file testFrameType.c
+ *
+ * Remote and error frames carry no signals: a candump -L line with an RTR
+ * frame or an error frame of a known ID has to be reported as not found by
+ * processAllFrames() and must not reach the subscribed callbacks of
+ * processFrame(). An ID filter selecting the frame rejects them as well. A
+ * data frame of the same ID is decoded as usual.
+ */
+
+/**
+Section: Included Files
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "processFrame.h"
+#include "parseLine.h"
+
+/**
+Section: Private Types
+*/
+
+typedef struct
+{
+	const char *line;
+	int decoded;  /**< Expected to be decoded */
+} TestFrameType_Line_t;
+
+/**
+Section: Private data
+*/
+
+static const TestFrameType_Line_t lines[] =
+{
+	{ "(2.0) vcan0 001#R", 0 },
+	{ "(2.0) vcan0 001#R8", 0 },
+	{ "(2.0) vcan0 20000001#0000000000000000", 0 },
+	{ "(2.0) vcan0 001#0100000000000000", 1 },
+};
+
+static unsigned int signals;
+static unsigned int notFound;
+
+/**
+Section: Private functions
+*/
+
+static void TestFrameType_Callback(const decoded_signal_t *decoded, __u64 timestamp, char *device)
+{
+	(void) timestamp;
+	(void) device;
+
+	if (NULL == decoded->frame)
+	{
+		notFound++;
+	}
+	else
+	{
+		signals++;
+	}
+}
+
+/**
+Section: Implementation
+*/
+
+int main(void)
+{
+	signal_callback_list_t *callbackList = NULL;
+	Dbc_Database_t *db;
+	IdFilter_t filter;
+	Dbc_Frame_t *frame;
+	struct canfd_frame cf;
+	const char *device;
+	size_t deviceLength;
+	__u64 timestamp;
+	unsigned int i, failures = 0;
+	int ret;
+
+	if (Dbc_Init(&db, "ccl_test.dbc") || NULL == (frame = Dbc_FindFrameByName(db, "testFrame1")))
+	{
+		fprintf(stderr, "FAIL: unable to load testFrame1 of ccl_test.dbc\n");
+		return EXIT_FAILURE;
+	}
+	add_callback(&callbackList, frame, NULL, TestFrameType_Callback, REPORT_ALWAYS, 0.);
+	IdFilter_Init(&filter);
+	if (IdFilter_Add(&filter, frame->canID))
+	{
+		return EXIT_FAILURE;
+	}
+
+	for (i = 0; i < sizeof(lines) / sizeof(lines[0]); i++)
+	{
+		ret = parseLine(lines[i].line, strlen(lines[i].line), &filter, &timestamp, &device, &deviceLength, &cf);
+		if (ret != (lines[i].decoded ? 0 : PARSE_LINE_REJECTED))
+		{
+			fprintf(stderr, "FAIL: %s: the ID filter returned %d\n", lines[i].line, ret);
+			failures++;
+		}
+
+		if (parseLine(lines[i].line, strlen(lines[i].line), NULL, &timestamp, &device, &deviceLength, &cf))
+		{
+			fprintf(stderr, "FAIL: %s: not parsed\n", lines[i].line);
+			failures++;
+			continue;
+		}
+
+		signals = notFound = 0;
+		processAllFrames(db, TestFrameType_Callback, &cf, timestamp, "vcan0");
+		if (lines[i].decoded ? (0 == signals || 0 != notFound) : (0 != signals || 1 != notFound))
+		{
+			fprintf(stderr, "FAIL: %s: processAllFrames() decoded %u signals, %u not found\n", lines[i].line, signals, notFound);
+			failures++;
+		}
+
+		signals = notFound = 0;
+		processFrame(callbackList, &cf, timestamp, "vcan0");
+		if (lines[i].decoded ? (0 == signals) : (0 != signals))
+		{
+			fprintf(stderr, "FAIL: %s: processFrame() decoded %u signals\n", lines[i].line, signals);
+			failures++;
+		}
+	}
+	printf("testFrameType: %u lines, %u failures\n", i, failures);
+
+	IdFilter_DeInit(&filter);
+	delete_callbacks(callbackList);
+	Dbc_DeInit(db);
+
+	return (0 == failures) ? EXIT_SUCCESS : EXIT_FAILURE;
+}